@@ -0,0 +1,134 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Checkpoints of a long run.  The simulation writes its whole state into a
+// Snapshot, a flat byte buffer of plain values and length-prefixed vectors,
+// and a CheckpointWriter saves it to disk on a background thread.  A snapshot
+// is only read back by the same build: the header carries a format version
+// and the sizes of the types that are copied byte for byte.
+
+#define CHECKPOINT_FILE "checkpoint.bin"
+
+class Snapshot
+{
+
+public:
+    Snapshot() : position(0) {}
+
+    void clear(void)
+    {
+        this->data.clear();
+        this->position = 0;
+    }
+
+    template <class T>
+    void put(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are copied byte for byte");
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        this->data.insert(this->data.end(), bytes, bytes + sizeof(T));
+    }
+
+    // A vector is its size, then its elements
+    template <class T>
+    void put(const std::vector<T> &values)
+    {
+        this->put(values.size());
+        this->append(values.data(), values.size());
+    }
+
+    // n values with no size in front, e.g. a vector written in pieces
+    template <class T>
+    void append(const T *values, size_t n)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are copied byte for byte");
+        const char *bytes = reinterpret_cast<const char *>(values);
+        this->data.insert(this->data.end(), bytes, bytes + n * sizeof(T));
+    }
+
+    // Reads go forward from the start; false once the snapshot runs out
+    template <class T>
+    bool get(T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are copied byte for byte");
+        if (this->data.size() - this->position < sizeof(T))
+            return false;
+        memcpy(&value, this->data.data() + this->position, sizeof(T));
+        this->position += sizeof(T);
+        return true;
+    }
+
+    template <class T>
+    bool get(std::vector<T> &values)
+    {
+        size_t n;
+
+        if (!this->get(n) || n > (this->data.size() - this->position) / sizeof(T))
+            return false;
+        values.resize(n);
+        if (n > 0)
+            memcpy(values.data(), this->data.data() + this->position, n * sizeof(T));
+        this->position += n * sizeof(T);
+        return true;
+    }
+
+    // True once every byte has been read
+    bool finished(void) const { return this->position == this->data.size(); }
+
+    bool read_file(const char *path);
+    bool write_file(const std::string &path) const;
+
+private:
+    std::vector<char> data;
+    size_t position;
+};
+
+// Double-buffered background writer.  The simulation fills next() while the
+// previous snapshot is still being written, and submit() hands it over, so the
+// event loop only waits if a write takes longer than the interval between
+// checkpoints.  Each snapshot goes to a temporary file that then replaces the
+// checkpoint, so a run stopped mid-write still leaves the last complete one.
+class CheckpointWriter
+{
+
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    void open(const char *path);
+
+    // Buffer for the next snapshot, cleared
+    Snapshot &next(void);
+
+    // Queue next() for writing; false if an earlier write failed
+    bool submit(void);
+
+    // Wait for the last write; false if any write failed
+    bool close(void);
+
+    bool is_open(void) const { return this->thread.joinable(); }
+
+private:
+    std::string path;
+    Snapshot buffers[2];
+    int filling;   // Buffer next() returns
+    bool pending;  // The other buffer is waiting for or being written
+    bool stopping; // close() has been called
+    bool failed;   // A write has failed
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread thread;
+
+    void work(void);
+};
+
+#endif // CHECKPOINT_H
\ No newline at end of file
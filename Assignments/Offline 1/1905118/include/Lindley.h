@@ -0,0 +1,30 @@
+#ifndef LINDLEY_H
+#define LINDLEY_H
+
+#include "RandGen.h"
+#include "Simulation.h"
+
+// Fast engine for the FIFO single-server queue.  Instead of an event list it
+// follows the Lindley recursion
+//
+//     W(n+1) = max(0, W(n) + S(n) - A(n+1))
+//
+// over blocks of interarrival times A and service times S.  It draws them from
+// the same substreams as the batched mode of Simulation (interarrivals from
+// split(1), service times from split(2)), so for the same rand_gen it gives
+// the statistics of Simulation::simulate in SAMPLING_BATCHED mode, up to
+// rounding in the last digits.
+//
+// The run stops when customer N starts service, at T = t(N) + W(N), as the
+// event-driven model does.  Customers 1..N wait for their whole delay within
+// [0, T], later arrivals before T wait until T, and the server is busy for
+// S(1) + ... + S(N-1).
+//
+// Each substream of the default generator holds about 2.7 * 10^8 draws.  For
+// longer runs, build with -DRANDGEN_GENERATOR=Xoshiro256pp.
+//
+// Returns SIMULATION_INVALID_PARAMS, leaving stats alone, if params do not
+// describe a model (e.g. no delays are required).
+SimulationStatus simulate_lindley(const SimulationParams &params, const RandGen &rand_gen, SimulationStats &stats);
+
+#endif // LINDLEY_H
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Growable FIFO on a circular array.  The capacity is always a power of two,
+// so wrapping around is a mask, and a full buffer doubles in place; push_back
+// is amortized O(1) and pop_front is O(1) however long the line gets.
+template <class T>
+class RingBuffer
+{
+
+public:
+    RingBuffer(size_t capacity = 16)
+    {
+        this->head = 0;
+        this->count = 0;
+        this->high_water = 0;
+        this->data.resize(round_up(capacity));
+        this->mask = this->data.size() - 1;
+    }
+
+    // Make room for at least capacity elements without further allocation
+    void reserve(size_t capacity)
+    {
+        if (capacity > this->data.size())
+            this->grow(round_up(capacity));
+    }
+
+    void push_back(const T &value)
+    {
+        if (this->count == this->data.size())
+            this->grow(2 * this->data.size());
+
+        this->data[(this->head + this->count) & this->mask] = value;
+        if (++this->count > this->high_water)
+            this->high_water = this->count;
+    }
+
+    void pop_front(void)
+    {
+        this->head = (this->head + 1) & this->mask;
+        --this->count;
+    }
+
+    T &front(void) { return this->data[this->head]; }
+    const T &front(void) const { return this->data[this->head]; }
+
+    // i-th element counted from the front
+    T &operator[](size_t i) { return this->data[(this->head + i) & this->mask]; }
+    const T &operator[](size_t i) const { return this->data[(this->head + i) & this->mask]; }
+
+    size_t size(void) const { return this->count; }
+    bool empty(void) const { return this->count == 0; }
+    size_t capacity(void) const { return this->data.size(); }
+
+    // Largest number of elements held at once since construction or clear()
+    size_t high_water_mark(void) const { return this->high_water; }
+
+    // Empty the buffer, keeping its storage
+    void clear(void)
+    {
+        this->head = 0;
+        this->count = 0;
+        this->high_water = 0;
+    }
+
+    // Write out and read back the elements, front first, and the high-water
+    // mark, for checkpoints (see Checkpoint.h)
+    template <class Writer>
+    void save(Writer &out) const
+    {
+        // Written as a vector would be, from the two contiguous runs of the array
+        size_t first = std::min(this->count, this->data.size() - this->head);
+
+        out.put(this->count);
+        out.append(this->data.data() + this->head, first);
+        out.append(this->data.data(), this->count - first);
+        out.put(this->high_water);
+    }
+
+    template <class Reader>
+    bool restore(Reader &in)
+    {
+        std::vector<T> elements;
+        size_t high_water;
+
+        if (!in.get(elements) || !in.get(high_water))
+            return false;
+
+        this->clear();
+        this->reserve(elements.size());
+        for (const T &element : elements)
+            this->push_back(element);
+        this->high_water = high_water;
+        return true;
+    }
+
+private:
+    std::vector<T> data;
+    size_t head, count, mask, high_water;
+
+    static size_t round_up(size_t n)
+    {
+        size_t size = 1;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    // Move the elements, in order, to the front of a larger array
+    void grow(size_t capacity)
+    {
+        std::vector<T> bigger(capacity);
+        for (size_t i = 0; i < this->count; ++i)
+            bigger[i] = (*this)[i];
+
+        this->data.swap(bigger);
+        this->head = 0;
+        this->mask = capacity - 1;
+    }
+};
+
+#endif // RINGBUFFER_H
\ No newline at end of file
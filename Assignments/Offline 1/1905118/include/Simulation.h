@@ -2,37 +2,189 @@
 #define SIMULATION_H
 
 #include <fstream>
+#include <istream>
+#include <string>
 #include <vector>
 #include <utility>
+#include "Checkpoint.h"
+#include "EventKernel.h"
 #include "RandGen.h"
+#include "RingBuffer.h"
+#include "Statistics.h"
+#include "Trace.h"
 
-class Simulation
+// Model parameters, as read from in.txt
+struct SimulationParams
 {
+    double mean_interarrival, mean_service;
+    int num_delays_required, num_servers;
+};
+
+// Measures of performance written by report()
+struct SimulationStats
+{
+    double avg_delay, avg_num_in_q, server_utilization, time_end;
+};
+
+// Regenerative estimates: one pair per cycle, the system emptying being the
+// regeneration point (valid as interarrival times are exponential)
+struct RegenerativeStats
+{
+    RatioStat delay;       // Cycle's total delay over its customers delayed
+    RatioStat num_in_q;    // Cycle's area under the queue length over its length
+    RatioStat utilization; // Cycle's busy time per server over its length
+
+    void merge(const RegenerativeStats &other)
+    {
+        this->delay.merge(other.delay);
+        this->num_in_q.merge(other.num_in_q);
+        this->utilization.merge(other.utilization);
+    }
+};
+
+// Outcome of a run; the library calls return it instead of exiting
+enum SimulationStatus
+{
+    SIMULATION_OK,
+    SIMULATION_INVALID_PARAMS,         // A mean is not positive, or there are no customers or servers
+    SIMULATION_EVENT_LIST_EMPTY,       // No event was left to process
+    SIMULATION_INVALID_EVENT,          // An event of unknown type was processed
+    SIMULATION_ENGINE_UNSUPPORTED,     // The Lindley engine was asked to run several servers
+    SIMULATION_FILE_ERROR,             // in.txt or an output file could not be opened (front-end only)
+    SIMULATION_CHECKPOINT_ERROR,       // A checkpoint could not be written, or read back by resume()
+    SIMULATION_CHECKPOINT_UNSUPPORTED  // Checkpoints were asked of the Lindley engine or a text or full trace
+};
+
+// Text for status, for front-ends to show
+const char *simulation_status_message(SimulationStatus status);
+
+// How run() simulates the model
+enum SimulationEngine
+{
+    ENGINE_EVENT_LIST, // Event-driven, with the out2.txt trace
+    ENGINE_LINDLEY     // Lindley recursion, single server only (see Lindley.h)
+};
+
+class Simulation : public EventKernel<Simulation, 2>
+{
+    friend class EventKernel<Simulation, 2>;
 
 public:
-    Simulation();
-    void run(void);
+    // File front-end: run() reads in.txt and writes out1.txt, with the trace
+    // chosen by trace_level in out2.txt or out2.bin.  No file is opened before run()
+    Simulation(SamplingMode sampling_mode = SAMPLING_REFERENCE, TraceLevel trace_level = TRACE_TEXT);
+    SimulationStatus run(SimulationEngine engine = ENGINE_EVENT_LIST);
+
+    // Library use: setup() takes the parameters and generator and turns tracing
+    // off; simulate() then runs the model once and returns its measures, without
+    // reading or writing any file.  An object can be set up again for the next
+    // run and keeps its event list, queue and server storage.  The constructor
+    // with parameters calls setup(); a failed setup is returned by simulate().
+    Simulation(const SimulationParams &params, const RandGen &rand_gen, SamplingMode sampling_mode = SAMPLING_REFERENCE);
+    SimulationStatus setup(const SimulationParams &params, const RandGen &rand_gen, SamplingMode sampling_mode = SAMPLING_REFERENCE);
+
+    // Run the model; on failure the measures are NaN
+    SimulationStatus simulate(SimulationStats &stats);
+
+    // Run until num_cycles regeneration cycles are complete, starting empty
+    // and idle, and return the cycles; independent calls can run in parallel
+    SimulationStatus simulate_cycles(long num_cycles, RegenerativeStats &cycles);
+
+    // Steady-state estimators over the last run: batch means of the delays
+    // and the completed regeneration cycles (the one in progress is left out)
+    const BatchMeans &delay_batch_means(void) const { return this->delay_batches; }
+    const RegenerativeStats &regenerative_stats(void) const { return this->regenerative; }
+
+    // Read parameters in the in.txt format; false if they are missing or invalid
+    static bool read_params(std::istream &in, SimulationParams &params);
+    static SimulationStatus check_params(const SimulationParams &params);
+
+    // Uniforms the busiest stream of one run is expected to take, to check
+    // against a replication's budget (see Replication.h)
+    static double expected_draws(const SimulationParams &params, SamplingMode sampling_mode);
+
+    // Longest the waiting line has been during the run
+    size_t max_num_in_q(void) const { return this->time_arrival.high_water_mark(); }
+
+    // Checkpoints for long runs: every interval events the whole state (clock,
+    // event list, queue, accumulators and generators) is saved to path by a
+    // background writer, replacing the previous checkpoint; 0 turns them off.
+    // resume() carries on the run saved in path with its own parameters,
+    // generator and trace level, checkpointing as before unless set_checkpoint()
+    // was called, and writes the same out1.txt as an uninterrupted run would.
+    // Checkpoints need the event-list engine and trace=off or trace=summary.
+    void set_checkpoint(const char *path, long long interval);
+    SimulationStatus resume(const char *path);
 
 private:
-    int next_event_type, num_custs_delayed, num_delays_required, num_events,
-        num_in_q, server_status, curr_event_num, next_event_cust;
+    int num_custs_delayed, num_delays_required,
+        num_in_q, num_servers, num_busy, next_event_cust,
+        next_event_server;
+    long long curr_event_num, num_departures;
     double area_num_in_q, area_server_status, mean_interarrival, mean_service,
-        sim_time, time_last_event, total_of_delays;
+        total_of_delays;
+
+    RingBuffer<double> time_arrival;
+    RingBuffer<int> cust_in_q;
+
+    // Per-server state; idle_servers is a stack of the servers that are free
+    std::vector<int> server_status, server_cust, idle_servers;
+    std::vector<double> service_start, server_busy_time;
 
-    std::vector<double> time_arrival;
-    std::vector<std::pair<double, int>> next_event_data;
+    // Steady-state estimators, and the totals of the current regeneration cycle
+    BatchMeans delay_batches;
+    RegenerativeStats regenerative;
+    long cycles_required;
+    int cycle_custs_delayed;
+    double cycle_start, cycle_total_of_delays, cycle_area_num_in_q, cycle_area_server_status;
 
     std::ifstream inFile;
     std::ofstream outFile1, outFile2;
+    TraceLevel trace_level;
+    TraceWriter trace_writer;
 
     RandGen rand_gen;
+    SamplingMode sampling_mode;
+    SimulationStatus status;
+    ExponentialBuffer interarrivals, service_times;
 
+    // Checkpointing; events_to_checkpoint counts down to the next one and is
+    // negative when they are off
+    std::string checkpoint_path;
+    long long checkpoint_interval, events_to_checkpoint;
+    CheckpointWriter checkpoint_writer;
+
+    void reset(void);
+    SimulationStatus start(void);
+    void init_servers(void);
     void init_event_list(void);
-    void timing(void);
+    void start_service(int server, int cust);
     void arrive(void);
     void depart(void);
-    void report(void);
-    void update_time_avg_stats(void);  
+    void end_cycle(void);
+    SimulationStatus run_events(void);
+    bool save_checkpoint(void);
+    void save(Snapshot &snapshot) const;
+    bool restore(Snapshot &snapshot);
+    void compute_stats(SimulationStats &stats) const;
+    SimulationStatus open_outputs(void);
+    void write_heading(void);
+    SimulationStatus close_outputs(SimulationStatus status, const SimulationStats &stats);
+    void report(const SimulationStats &stats);
+    void trace_event(int type, bool began_service);
+    void trace_summary(void);
+    void update_time_avg_stats(double time_since_last_event);
+
+    // Whether enough delays (or regeneration cycles) are done
+    bool finished(void) const { return this->cycles_required > 0 ? this->regenerative.delay.count() >= this->cycles_required : this->num_custs_delayed >= this->num_delays_required; }
+
+    // Event kernel hooks: 0 is an arrival carrying its customer, 1 a departure
+    // carrying its server, which knows its customer.  The kernel also stops
+    // when a checkpoint is due.
+    bool done(void) const { return this->finished() || this->events_to_checkpoint == 0; }
+    void accumulate(double elapsed) { --this->events_to_checkpoint; this->update_time_avg_stats(elapsed); }
+    void handle(EventType<0>, const Event &event) { this->next_event_cust = event.data; this->arrive(); }
+    void handle(EventType<1>, const Event &event) { this->next_event_server = event.data; this->next_event_cust = this->server_cust[event.data]; this->depart(); }
 };
 
 #endif // SIMULATION_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "RandGen.h"
+#include "Simulation.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+// Parameter sweeps: the model is run at every point of the Cartesian product
+// of a list of values per parameter, all in one process.  A specification has
+// one line per swept parameter,
+//
+//     mean_service 0.5:0.95:0.05          start:stop:step, stop included
+//     num_servers 1, 2, 4                 a list; ranges and values can be mixed
+//     replications 10                     independent replications per point
+//     engine lindley                      event_list (default) or lindley
+//
+// and parameters it leaves out keep their values from in.txt.  Blank lines
+// and lines starting with # are skipped.
+
+struct SweepAxis
+{
+    std::string name;           // Parameter name, as in SimulationParams
+    std::vector<double> values; // Values it takes
+};
+
+struct SweepSpec
+{
+    std::vector<SweepAxis> axes;
+    int num_replications;
+    SimulationEngine engine;
+};
+
+// One point of the sweep and its estimates over the replications
+struct SweepResult
+{
+    SimulationParams params;
+    RunningStat avg_delay, avg_num_in_q, server_utilization, time_end;
+};
+
+// Read a specification; false with error set if it is malformed
+bool read_sweep(std::istream &in, SweepSpec &spec, std::string &error);
+
+// Parameters of every point, base with the swept parameters replaced; the
+// last axis varies fastest
+std::vector<SimulationParams> sweep_points(const SimulationParams &base, const SweepSpec &spec);
+
+// Run every replication of every point on the pool.  Replication r of each
+// point uses substream r, so the points are compared under common random
+// numbers and the results do not depend on the number of threads.
+std::vector<SweepResult> run_sweep(ThreadPool &pool, const std::vector<SimulationParams> &points, const SweepSpec &spec,
+                                   SamplingMode sampling_mode);
+
+// One CSV row per point: the parameters, then each measure's mean and, with
+// more than one replication, its 95% confidence half-length
+void write_sweep_csv(std::ostream &out, const std::vector<SweepResult> &results);
+
+#endif // SWEEP_H
\ No newline at end of file
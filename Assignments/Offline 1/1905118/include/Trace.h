@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+// How much of the event trace the simulation writes
+enum TraceLevel
+{
+    TRACE_OFF,     // Nothing; tracing costs one predictable branch per event
+    TRACE_SUMMARY, // Event counts and the longest queue in out2.txt, written once at the end
+    TRACE_FULL,    // One binary TraceRecord per event in out2.bin; decode_trace turns it into text
+    TRACE_TEXT     // The coursework text trace in out2.txt, formatted as the events happen
+};
+
+#define TRACE_BUFFER 4096 // Records buffered before each write
+
+#define TRACE_ARRIVAL 0
+#define TRACE_DEPARTURE 1
+#define TRACE_BEGAN_SERVICE 2 // Added to the type when a customer began service during the event
+
+// One event of the binary trace
+struct TraceRecord
+{
+    double time;         // Simulation time of the event
+    long long event_num; // Event number, from 1
+    int cust;            // Customer arriving or departing
+    int type;            // TRACE_ARRIVAL or TRACE_DEPARTURE, plus TRACE_BEGAN_SERVICE
+};
+
+// Buffered writer for the binary trace.  The file starts with a short header
+// so the decoder can reject files that are not traces or that were written
+// with a different record layout.
+class TraceWriter
+{
+
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    bool open(const char *path);
+    void close(void);
+
+    void write(const TraceRecord &record)
+    {
+        this->buffer[this->count++] = record;
+        if (this->count == TRACE_BUFFER)
+            this->flush();
+    }
+
+private:
+    std::ofstream file;
+    std::vector<TraceRecord> buffer;
+    size_t count;
+
+    void flush(void);
+};
+
+// Write one event in the coursework text format; num_custs_delayed is the
+// count after the event, printed when a customer began service
+void write_trace_text(std::ostream &out, long long event_num, int cust, int type, int num_custs_delayed);
+
+// Regenerate the text trace from a binary one; false if in_path is not a trace
+bool decode_trace(const char *in_path, const char *out_path);
+
+#endif // TRACE_H
\ No newline at end of file
@@ -1,3 +1,2 @@
 #define IDLE 0
-#define BUSY 1
-#define INF 1.0e+30
\ No newline at end of file
+#define BUSY 1
\ No newline at end of file
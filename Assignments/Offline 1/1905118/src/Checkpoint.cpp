@@ -0,0 +1,115 @@
+#include "../include/Checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+bool Snapshot::read_file(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file)
+        return false;
+
+    this->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    this->position = 0;
+
+    return !file.bad();
+}
+
+bool Snapshot::write_file(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    file.write(this->data.data(), this->data.size());
+    file.close();
+
+    return !file.fail();
+}
+
+CheckpointWriter::CheckpointWriter()
+{
+    this->filling = 0;
+    this->pending = false;
+    this->stopping = false;
+    this->failed = false;
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    this->close();
+}
+
+void CheckpointWriter::open(const char *path)
+{
+    this->close();
+
+    this->path = path;
+    this->filling = 0;
+    this->pending = false;
+    this->stopping = false;
+    this->failed = false;
+    this->thread = std::thread(&CheckpointWriter::work, this);
+}
+
+Snapshot &CheckpointWriter::next(void)
+{
+    // The writer thread only touches the other buffer, so this one is free
+    this->buffers[this->filling].clear();
+    return this->buffers[this->filling];
+}
+
+bool CheckpointWriter::submit(void)
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    // Wait for the previous snapshot to be written, then swap buffers
+    this->changed.wait(lock, [this] { return !this->pending; });
+    if (this->failed)
+        return false;
+
+    this->pending = true;
+    this->filling = 1 - this->filling;
+    this->changed.notify_all();
+
+    return true;
+}
+
+bool CheckpointWriter::close(void)
+{
+    if (!this->thread.joinable())
+        return !this->failed;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+    this->thread.join();
+
+    return !this->failed;
+}
+
+void CheckpointWriter::work(void)
+{
+    std::string temporary = this->path + ".tmp";
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    for (;;)
+    {
+        this->changed.wait(lock, [this] { return this->pending || this->stopping; });
+        if (!this->pending)
+            return;
+
+        // Write the submitted buffer without holding the lock, then move it into place
+        const Snapshot &snapshot = this->buffers[1 - this->filling];
+        lock.unlock();
+        bool written = snapshot.write_file(temporary) && std::rename(temporary.c_str(), this->path.c_str()) == 0;
+        lock.lock();
+
+        if (!written)
+            this->failed = true;
+        this->pending = false;
+        this->changed.notify_all();
+    }
+}
\ No newline at end of file
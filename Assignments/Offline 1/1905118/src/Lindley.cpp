@@ -0,0 +1,81 @@
+#include "../include/Lindley.h"
+
+#include <algorithm>
+
+SimulationStatus simulate_lindley(const SimulationParams &params, const RandGen &rand_gen, SimulationStats &stats)
+{
+    int i, block, counted = 0, remaining;
+    double delay, last_delay, arrival, time_end, block_delays, block_services, block_gaps;
+    double total_of_delays, busy_time, area_tail;
+    double service[RANDGEN_BLOCK], gap[RANDGEN_BLOCK] = {0.0}, change[RANDGEN_BLOCK];
+    RandGen base = rand_gen;
+    ExponentialBuffer interarrivals, service_times;
+
+    if (Simulation::check_params(params) != SIMULATION_OK)
+        return SIMULATION_INVALID_PARAMS;
+
+    // Same substreams and block sizes as the batched event-driven model
+    interarrivals.init(base, params.mean_interarrival, SAMPLING_BATCHED, 1);
+    service_times.init(base, params.mean_service, SAMPLING_BATCHED, 2);
+
+    // The first customer arrives after one interarrival time and does not wait
+    arrival = interarrivals.next();
+    delay = last_delay = 0.0;
+    total_of_delays = busy_time = 0.0;
+
+    // Customer n takes service[i] and the next customer arrives gap[i] later.
+    // Sums are kept per block so a long run does not lose precision adding
+    // small terms to large totals.
+    for (remaining = params.num_delays_required; remaining > 0; remaining -= block)
+    {
+        block = std::min(remaining, RANDGEN_BLOCK);
+
+        for (i = 0; i < block; ++i)
+        {
+            service[i] = service_times.next();
+            gap[i] = interarrivals.next();
+        }
+
+        // Change in the workload seen by successive arrivals
+        for (i = 0; i < block; ++i)
+            change[i] = service[i] - gap[i];
+
+        // Lindley recursion: the only serial part
+        block_delays = 0.0;
+        for (i = 0; i < block; ++i)
+        {
+            block_delays += delay;
+            last_delay = delay;
+            delay = std::max(0.0, delay + change[i]);
+        }
+
+        // Customer N starts service at T, so its service and the gap after it are not part of the run
+        counted = remaining == block ? block - 1 : block;
+
+        block_services = block_gaps = 0.0;
+        for (i = 0; i < counted; ++i)
+        {
+            block_services += service[i];
+            block_gaps += gap[i];
+        }
+
+        total_of_delays += block_delays;
+        busy_time += block_services;
+        arrival += block_gaps;
+    }
+
+    // The run ends when customer N starts service
+    time_end = arrival + last_delay;
+
+    // Customers arriving before then are still in the queue at the end
+    area_tail = 0.0;
+    for (arrival += gap[counted]; arrival < time_end; arrival += interarrivals.next())
+        area_tail += time_end - arrival;
+
+    stats.avg_delay = total_of_delays / params.num_delays_required;
+    stats.avg_num_in_q = (total_of_delays + area_tail) / time_end;
+    stats.server_utilization = busy_time / time_end;
+    stats.time_end = time_end;
+
+    return SIMULATION_OK;
+}
\ No newline at end of file
@@ -1,133 +1,219 @@
 #include "../include/Simulation.h"
 #include "../include/defs.h"
+#include "../include/Lindley.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
-Simulation::Simulation()
-{
-    // open outFile2
-    this->outFile2.open("out2.txt");
+static const char checkpoint_magic[8] = {'M', 'M', 'C', 'C', 'K', 'P', 'N', 'T'};
+static const int checkpoint_version = 1;
+
+// Name of the generator the build uses, so a checkpoint is not resumed by a
+// build drawing from a different one
+#define CHECKPOINT_STRING(x) #x
+#define CHECKPOINT_NAME(x) CHECKPOINT_STRING(x)
 
-    if (!this->outFile2)
+const char *simulation_status_message(SimulationStatus status)
+{
+    switch (status)
     {
-        std::cout << "Error opening output file2\n";
-        exit(1);
+    case SIMULATION_OK:
+        return "ok";
+    case SIMULATION_INVALID_PARAMS:
+        return "invalid input parameters";
+    case SIMULATION_EVENT_LIST_EMPTY:
+        return "event list empty";
+    case SIMULATION_INVALID_EVENT:
+        return "an event of unknown type was processed";
+    case SIMULATION_ENGINE_UNSUPPORTED:
+        return "the Lindley engine needs a single server";
+    case SIMULATION_FILE_ERROR:
+        return "cannot open the input or output files";
+    case SIMULATION_CHECKPOINT_ERROR:
+        return "cannot write or read back the checkpoint";
+    case SIMULATION_CHECKPOINT_UNSUPPORTED:
+        return "checkpoints need the event-list engine and trace=off or trace=summary";
     }
+    return "unknown status";
+}
 
+Simulation::Simulation(SamplingMode sampling_mode, TraceLevel trace_level)
+{
+    // Remember how interarrival and service times are sampled and how much to
+    // trace; the files are opened by run()
+    this->sampling_mode = sampling_mode;
+    this->trace_level = trace_level;
+    this->status = SIMULATION_OK;
+    this->checkpoint_interval = 0;
+
+    this->reset();
+}
+
+Simulation::Simulation(const SimulationParams &params, const RandGen &rand_gen, SamplingMode sampling_mode)
+{
+    this->checkpoint_interval = 0;
+    this->setup(params, rand_gen, sampling_mode);
+}
+
+void Simulation::set_checkpoint(const char *path, long long interval)
+{
+    this->checkpoint_path = path;
+    this->checkpoint_interval = interval > 0 ? interval : 0;
+}
+
+SimulationStatus Simulation::setup(const SimulationParams &params, const RandGen &rand_gen, SamplingMode sampling_mode)
+{
+    // Take the parameters and generator; nothing is traced
+    this->mean_interarrival = params.mean_interarrival;
+    this->mean_service = params.mean_service;
+    this->num_delays_required = params.num_delays_required;
+    this->num_servers = params.num_servers;
+    this->rand_gen = rand_gen;
+    this->sampling_mode = sampling_mode;
+    this->trace_level = TRACE_OFF;
+    this->status = check_params(params);
+
+    this->reset();
+
+    return this->status;
+}
+
+void Simulation::reset(void)
+{
     // Specify current event number to be 0
     this->curr_event_num = 0;
+    this->num_departures = 0;
 
     // Specify next event customer to be 0
     this->next_event_cust = 0;
 
-    // Specify the number of events for the timing function
-    this->num_events = 2;
-
-    // Initialize the simulation clock
-    this->sim_time = 0.0;
+    // Initialize the simulation clock and empty the event list
+    this->resetKernel();
 
     // Initialize the state variables
-    this->server_status = IDLE;
+    this->num_busy = 0;
     this->num_in_q = 0;
-    this->time_last_event = 0.0;
+    this->events_to_checkpoint = -1;
 
     // Initialize the statistical counters
     this->num_custs_delayed = 0;
     this->total_of_delays = 0.0;
     this->area_num_in_q = 0.0;
     this->area_server_status = 0.0;
-    
-    this->next_event_data.resize(this->num_events);
 
+    // Initialize the steady-state estimators; the first cycle starts empty at time 0
+    this->delay_batches.clear();
+    this->regenerative = RegenerativeStats();
+    this->cycles_required = 0;
+    this->cycle_custs_delayed = 0;
+    this->cycle_start = 0.0;
+    this->cycle_total_of_delays = 0.0;
+    this->cycle_area_num_in_q = 0.0;
+    this->cycle_area_server_status = 0.0;
+
+    // Empty the waiting line left by an earlier run, keeping its storage, and
+    // reserve room up front; it still grows if it has to
+    this->time_arrival.clear();
+    this->cust_in_q.clear();
+    this->time_arrival.reserve(1024);
+    this->cust_in_q.reserve(1024);
 }
 
-void Simulation::init_event_list(void)
-{
-    // Initialize the event list with the arrival event
-    this->next_event_data[0] = std::make_pair(this->sim_time + this->rand_gen.get(this->mean_interarrival), 1);
-    this->next_event_data[1] = std::make_pair(INF, -1);
-}
-
-void Simulation::timing(void)
+void Simulation::init_servers(void)
 {
     int i;
-    double min_next_event_data = 1.0e+29;
 
-    this->next_event_type = -1;
+    // All servers start idle; push them so that server 0 is taken first
+    this->server_status.assign(this->num_servers, IDLE);
+    this->server_cust.assign(this->num_servers, 0);
+    this->service_start.assign(this->num_servers, 0.0);
+    this->server_busy_time.assign(this->num_servers, 0.0);
 
-    // Determine the event type of the next event to occur
-    for (i = 0; i < this->num_events; ++i)
-    {
-        if (this->next_event_data[i].first < min_next_event_data)
-        {
-            min_next_event_data = this->next_event_data[i].first;
-            this->next_event_type = i;
-            this->next_event_cust = this->next_event_data[i].second;
-        }
-    }
+    this->idle_servers.clear();
+    for (i = this->num_servers - 1; i >= 0; --i)
+        this->idle_servers.push_back(i);
+}
 
-    // Check to see if the event list is empty
-    if (this->next_event_type == -1)
-    {
-        // The event list is empty, so stop the simulation
-        std::cout << "\nEvent list empty at time " << this->sim_time << '\n';
-        exit(1);
-    }
+void Simulation::init_event_list(void)
+{
+    // Initialize the event list with the arrival of customer 1; no departure is pending
+    this->eventList.clear();
+    this->eventList.schedule(this->simulationTime + this->interarrivals.next(), 0, 1);
+}
 
-    // The event list is not empty, so advance the simulation clock
-    this->sim_time = min_next_event_data;
+void Simulation::start_service(int server, int cust) {
+    // Make the server busy with the customer and schedule its departure (service completion)
+    this->server_status[server] = BUSY;
+    this->server_cust[server] = cust;
+    this->service_start[server] = this->simulationTime;
+    this->eventList.schedule(this->simulationTime + this->service_times.next(), 1, server);
 }
 
 void Simulation::arrive(void) {
+    int server;
     double delay;
-
-    // print next event : arrival
-    this->outFile2 << ++this->curr_event_num << ". Next event: Customer " << this->next_event_cust << " Arrival\n";
+    bool began_service = false;
 
     // Schedule next arrival
-    this->next_event_data[0] = std::make_pair(this->sim_time + this->rand_gen.get(this->mean_interarrival), this->next_event_cust + 1);
+    this->eventList.schedule(this->simulationTime + this->interarrivals.next(), 0, this->next_event_cust + 1);
 
-    // Check to see if server is busy
-    if (this->server_status == BUSY)
+    // Check to see if all servers are busy
+    if (this->idle_servers.empty())
     {
-        // Server is busy, so increment number of customers in queue
+        // All servers are busy, so increment number of customers in queue
         ++this->num_in_q;        
 
         // There is room in the queue, so store the time of arrival of the arriving customer at the (new) end of time_arrival
-        this->time_arrival.push_back(this->sim_time);
+        this->time_arrival.push_back(this->simulationTime);
+        this->cust_in_q.push_back(this->next_event_cust);
     }
     else
     {
-        // Server is idle, so arriving customer has a delay of zero
+        // A server is idle, so arriving customer has a delay of zero
         delay = 0.0;
         this->total_of_delays += delay;
+        this->cycle_total_of_delays += delay;
+        this->delay_batches.add(delay);
 
-        // Increment the number of customers delayed, and make server busy
+        // Increment the number of customers delayed, and make an idle server busy
         ++this->num_custs_delayed;
-        this->server_status = BUSY;
-
-        // print number of customers delayed
-        this->outFile2 << "\n---------No. of customers delayed: " << this->num_custs_delayed << "--------\n\n";
+        ++this->cycle_custs_delayed;
+        server = this->idle_servers.back();
+        this->idle_servers.pop_back();
+        ++this->num_busy;
 
         // Schedule a departure (service completion)
-        this->next_event_data[1] = std::make_pair(this->sim_time + this->rand_gen.get(this->mean_service), this->next_event_cust);
+        this->start_service(server, this->next_event_cust);
+        began_service = true;
     }
+
+    // trace the arrival, and whether the customer went straight into service
+    if (this->trace_level != TRACE_OFF)
+        this->trace_event(TRACE_ARRIVAL, began_service);
 }
 
 void Simulation::depart(void) {
-    int i;
+    int server = this->next_event_server;
     double delay;
+    bool began_service = false;
 
-    // print next event: departure    
-    this->outFile2 << ++this->curr_event_num << ". Next event: Customer " << this->next_event_cust << " Departure\n";
+    // Add the finished service to the server's busy time
+    this->server_busy_time[server] += this->simulationTime - this->service_start[server];
 
     // Check to see if queue is empty
     if (this->num_in_q == 0)
     {
-        // The queue is empty, so make the server idle and eliminate the departure (service completion) event from consideration
-        this->server_status = IDLE;
-        this->next_event_data[1] = std::make_pair(INF, -1);
+        // The queue is empty, so make the server idle; no departure (service completion) event is scheduled
+        this->server_status[server] = IDLE;
+        this->idle_servers.push_back(server);
+        --this->num_busy;
+
+        // The system is now empty and idle, which ends a regeneration cycle
+        if (this->num_busy == 0)
+            this->end_cycle();
     }
     else
     {
@@ -135,104 +221,518 @@ void Simulation::depart(void) {
         --this->num_in_q;
 
         // Compute the delay of the customer who is beginning service and update the total delay accumulator
-        delay = (this->sim_time - this->time_arrival[0]);
+        delay = (this->simulationTime - this->time_arrival.front());
         this->total_of_delays += delay;
+        this->cycle_total_of_delays += delay;
+        this->delay_batches.add(delay);
 
-        // Increment the number of customers delayed, and schedule the departure
+        // Increment the number of customers delayed, and start serving the customer at the head of the queue
         ++this->num_custs_delayed;
-        this->next_event_data[1] = std::make_pair(this->sim_time + this->rand_gen.get(this->mean_service), this->next_event_cust + 1);
+        ++this->cycle_custs_delayed;
+        this->start_service(server, this->cust_in_q.front());
+        began_service = true;
 
-        // print number of customers delayed
-        this->outFile2 << "\n---------No. of customers delayed: " << this->num_custs_delayed << "--------\n\n";
-
-        // Move each customer in queue (if any) up one place
-        this->time_arrival.erase(this->time_arrival.begin());
+        // Remove the customer from the head of the queue
+        this->time_arrival.pop_front();
+        this->cust_in_q.pop_front();
     }
+
+    // trace the departure, and whether the next customer in the queue began service
+    if (this->trace_level != TRACE_OFF)
+        this->trace_event(TRACE_DEPARTURE, began_service);
 }
 
-void Simulation::update_time_avg_stats(void) {
-    double time_since_last_event;
+void Simulation::end_cycle(void) {
+    double cycle_length = this->simulationTime - this->cycle_start;
+
+    // Record the cycle's totals, then start the next cycle
+    this->regenerative.delay.add(this->cycle_total_of_delays, this->cycle_custs_delayed);
+    this->regenerative.num_in_q.add(this->cycle_area_num_in_q, cycle_length);
+    this->regenerative.utilization.add(this->cycle_area_server_status / this->num_servers, cycle_length);
+
+    this->cycle_start = this->simulationTime;
+    this->cycle_custs_delayed = 0;
+    this->cycle_total_of_delays = 0.0;
+    this->cycle_area_num_in_q = 0.0;
+    this->cycle_area_server_status = 0.0;
+}
+
+void Simulation::trace_event(int type, bool began_service) {
+    TraceRecord record;
+
+    ++this->curr_event_num;
+    if (type == TRACE_DEPARTURE)
+        ++this->num_departures;
+    if (began_service)
+        type += TRACE_BEGAN_SERVICE;
 
-    // Compute time since last event, and update last-event-time marker
-    time_since_last_event = (this->sim_time - this->time_last_event);
-    this->time_last_event = this->sim_time;
+    // Text is formatted now; a full trace only stores the record
+    if (this->trace_level == TRACE_TEXT)
+        write_trace_text(this->outFile2, this->curr_event_num, this->next_event_cust, type, this->num_custs_delayed);
+    else if (this->trace_level == TRACE_FULL)
+    {
+        record.time = this->simulationTime;
+        record.event_num = this->curr_event_num;
+        record.cust = this->next_event_cust;
+        record.type = type;
+        this->trace_writer.write(record);
+    }
+}
 
+void Simulation::trace_summary(void) {
+    // Write event counts in the layout of out1.txt
+    this->outFile2 << "Trace summary\n\n"
+                   << std::left << std::setw(30) << "Events:" << std::right << std::setw(10) << this->curr_event_num << '\n'
+                   << std::left << std::setw(30) << "Arrivals:" << std::right << std::setw(10) << (this->curr_event_num - this->num_departures) << '\n'
+                   << std::left << std::setw(30) << "Departures:" << std::right << std::setw(10) << this->num_departures << '\n'
+                   << std::left << std::setw(30) << "Customers delayed:" << std::right << std::setw(10) << this->num_custs_delayed << '\n'
+                   << std::left << std::setw(30) << "Longest queue:" << std::right << std::setw(10) << this->max_num_in_q() << '\n';
+}
+
+void Simulation::update_time_avg_stats(double time_since_last_event) {
     // Update area under number-in-queue function
     this->area_num_in_q += (this->num_in_q * time_since_last_event);
+    this->cycle_area_num_in_q += (this->num_in_q * time_since_last_event);
 
-    // Update area under server-busy indicator function
-    this->area_server_status += (this->server_status * time_since_last_event);    
+    // Update area under number-of-busy-servers function
+    this->area_server_status += (this->num_busy * time_since_last_event);
+    this->cycle_area_server_status += (this->num_busy * time_since_last_event);
 }
 
-void Simulation::report(void) {
-    // Compute and write estimates of desired measures of performance
+void Simulation::report(const SimulationStats &stats) {
+    int i;
+    double busy_time;
+
+    // Write estimates of desired measures of performance
     this->outFile1 << "\n\n"
-                   << std::left << std::setw(30) << "Average delay in queue:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << (this->total_of_delays / this->num_custs_delayed) << " minutes\n"
-                   << std::left << std::setw(30) << "Average number in queue:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << (this->area_num_in_q / this->sim_time) << '\n'
-                   << std::left << std::setw(30) << "Server utilization:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << (this->area_server_status / this->sim_time) << '\n'
-                   << std::left << std::setw(30) << "Time simulation ended:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << this->sim_time << " minutes\n";
+                   << std::left << std::setw(30) << "Average delay in queue:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << stats.avg_delay << " minutes\n"
+                   << std::left << std::setw(30) << "Average number in queue:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << stats.avg_num_in_q << '\n'
+                   << std::left << std::setw(30) << "Server utilization:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << stats.server_utilization << '\n'
+                   << std::left << std::setw(30) << "Time simulation ended:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << stats.time_end << " minutes\n";
+
+    if (this->num_servers == 1)
+        return;
+
+    // Write the utilization of each server, counting services still in progress
+    this->outFile1 << "\n" << std::left << std::setw(30) << "Server" << std::right << std::setw(10) << "Utilization" << '\n';
+    for (i = 0; i < this->num_servers; ++i)
+    {
+        busy_time = this->server_busy_time[i];
+        if (this->server_status[i] == BUSY)
+            busy_time += this->simulationTime - this->service_start[i];
+
+        this->outFile1 << std::left << std::setw(30) << (i + 1) << std::right << std::setw(10) << std::fixed << std::setprecision(3) << (busy_time / this->simulationTime) << '\n';
+    }
 }
 
-void Simulation::run(void) {
-    this->inFile.open("in.txt");
-    this->outFile1.open("out1.txt");
+bool Simulation::read_params(std::istream &in, SimulationParams &params)
+{
+    // Read input parameters; the number of servers is optional and defaults to 1
+    if (!(in >> params.mean_interarrival >> params.mean_service >> params.num_delays_required))
+        return false;
 
-    if (!this->inFile)
+    if (!(in >> params.num_servers))
+        params.num_servers = 1;
+
+    return check_params(params) == SIMULATION_OK;
+}
+
+SimulationStatus Simulation::check_params(const SimulationParams &params)
+{
+    if (params.mean_interarrival > 0.0 && params.mean_service > 0.0 && params.num_delays_required > 0 && params.num_servers >= 1)
+        return SIMULATION_OK;
+    return SIMULATION_INVALID_PARAMS;
+}
+
+double Simulation::expected_draws(const SimulationParams &params, SamplingMode sampling_mode)
+{
+    // Arrivals keep coming until customer N starts service, about rho of them per delay when the queue is unstable
+    double rho = params.mean_service / (params.num_servers * params.mean_interarrival);
+    double arrivals = params.num_delays_required * std::max(1.0, rho), services = params.num_delays_required;
+
+    // Batched mode gives each distribution its own stream and reads a block ahead
+    if (sampling_mode == SAMPLING_BATCHED)
+        return std::max(arrivals, services) + RANDGEN_BLOCK;
+    return arrivals + services;
+}
+
+SimulationStatus Simulation::start(void)
+{
+    if (this->status != SIMULATION_OK)
+        return this->status;
+
+    // Set up the interarrival and service time samplers (own substreams in batched mode)
+    this->interarrivals.init(this->rand_gen, this->mean_interarrival, this->sampling_mode, 1);
+    this->service_times.init(this->rand_gen, this->mean_service, this->sampling_mode, 2);
+
+    // Initialize the simulation
+    this->init_servers();
+    this->init_event_list();
+
+    return SIMULATION_OK;
+}
+
+SimulationStatus Simulation::run_events(void)
+{
+    KernelStatus kernel_status;
+    bool saved = true;
+
+    // Count down to the first checkpoint; with none the count never reaches 0
+    if (this->checkpoint_interval > 0)
+    {
+        this->events_to_checkpoint = this->checkpoint_interval;
+        this->checkpoint_writer.open(this->checkpoint_path.c_str());
+    }
+
+    // Run the simulation until enough delays (or regeneration cycles) are done,
+    // stopping each time a checkpoint is due to hand one to the writer
+    for (;;)
+    {
+        kernel_status = this->runEvents();
+        if (kernel_status != KERNEL_DONE || this->finished())
+            break;
+
+        saved = this->save_checkpoint();
+        if (!saved)
+            break;
+    }
+
+    // Wait for the last checkpoint to be written
+    if (!this->checkpoint_writer.close() || !saved)
+        return SIMULATION_CHECKPOINT_ERROR;
+
+    switch (kernel_status)
     {
-        std::cout << "Error opening input file\n";
-        exit(1);
+    case KERNEL_EVENT_LIST_EMPTY:
+        return SIMULATION_EVENT_LIST_EMPTY;
+    case KERNEL_INVALID_EVENT:
+        return SIMULATION_INVALID_EVENT;
+    default:
+        return SIMULATION_OK;
     }
+}
+
+bool Simulation::save_checkpoint(void)
+{
+    this->save(this->checkpoint_writer.next());
+    this->events_to_checkpoint = this->checkpoint_interval;
+
+    return this->checkpoint_writer.submit();
+}
+
+void Simulation::save(Snapshot &snapshot) const
+{
+    std::string generator = CHECKPOINT_NAME(RANDGEN_GENERATOR);
+    std::vector<Event> events;
+
+    // Header: magic, format version, the generator, and the sizes of the types copied byte for byte
+    snapshot.put(checkpoint_magic);
+    snapshot.put(checkpoint_version);
+    snapshot.put(std::vector<char>(generator.begin(), generator.end()));
+    snapshot.put(sizeof(RandGen));
+    snapshot.put(sizeof(Event));
+    snapshot.put(sizeof(RegenerativeStats));
+
+    // Parameters and settings
+    snapshot.put(this->mean_interarrival);
+    snapshot.put(this->mean_service);
+    snapshot.put(this->num_delays_required);
+    snapshot.put(this->num_servers);
+    snapshot.put(this->sampling_mode);
+    snapshot.put(this->trace_level);
+    snapshot.put(this->checkpoint_interval);
+    snapshot.put(this->cycles_required);
+
+    // Clock, state variables and statistical counters
+    snapshot.put(this->simulationTime);
+    snapshot.put(this->timeOfLastEvent);
+    snapshot.put(this->num_custs_delayed);
+    snapshot.put(this->num_in_q);
+    snapshot.put(this->num_busy);
+    snapshot.put(this->next_event_cust);
+    snapshot.put(this->next_event_server);
+    snapshot.put(this->curr_event_num);
+    snapshot.put(this->num_departures);
+    snapshot.put(this->area_num_in_q);
+    snapshot.put(this->area_server_status);
+    snapshot.put(this->total_of_delays);
+
+    // Queue and servers
+    this->time_arrival.save(snapshot);
+    this->cust_in_q.save(snapshot);
+    snapshot.put(this->server_status);
+    snapshot.put(this->server_cust);
+    snapshot.put(this->idle_servers);
+    snapshot.put(this->service_start);
+    snapshot.put(this->server_busy_time);
+
+    // Pending events in the order they will occur; scheduling them again in
+    // this order keeps the order of ties
+    this->eventList.forEach([&events](const Event &event) { events.push_back(event); });
+    std::sort(events.begin(), events.end(), eventBefore);
+    snapshot.put(events);
+
+    // Steady-state estimators
+    this->delay_batches.save(snapshot);
+    snapshot.put(this->regenerative);
+    snapshot.put(this->cycle_custs_delayed);
+    snapshot.put(this->cycle_start);
+    snapshot.put(this->cycle_total_of_delays);
+    snapshot.put(this->cycle_area_num_in_q);
+    snapshot.put(this->cycle_area_server_status);
+
+    // Generators
+    snapshot.put(this->rand_gen);
+    this->interarrivals.save(snapshot);
+    this->service_times.save(snapshot);
+}
+
+bool Simulation::restore(Snapshot &snapshot)
+{
+    char magic[sizeof(checkpoint_magic)];
+    int version;
+    std::string generator = CHECKPOINT_NAME(RANDGEN_GENERATOR);
+    std::vector<char> saved_generator;
+    size_t rand_gen_size, event_size, regenerative_size;
+    SimulationParams params;
+    long long saved_interval;
+    std::vector<Event> events;
+
+    // Check the header
+    if (!snapshot.get(magic) || memcmp(magic, checkpoint_magic, sizeof(magic)) != 0 || !snapshot.get(version) || version != checkpoint_version)
+        return false;
+    if (!snapshot.get(saved_generator) || std::string(saved_generator.begin(), saved_generator.end()) != generator)
+        return false;
+    if (!snapshot.get(rand_gen_size) || !snapshot.get(event_size) || !snapshot.get(regenerative_size) ||
+        rand_gen_size != sizeof(RandGen) || event_size != sizeof(Event) || regenerative_size != sizeof(RegenerativeStats))
+        return false;
+
+    // Parameters and settings; an interval from set_checkpoint() takes precedence
+    if (!snapshot.get(params.mean_interarrival) || !snapshot.get(params.mean_service) || !snapshot.get(params.num_delays_required) ||
+        !snapshot.get(params.num_servers) || check_params(params) != SIMULATION_OK)
+        return false;
+    this->setup(params, this->rand_gen, SAMPLING_REFERENCE);
+    if (!snapshot.get(this->sampling_mode) || !snapshot.get(this->trace_level) || !snapshot.get(saved_interval) || !snapshot.get(this->cycles_required))
+        return false;
+    if (this->checkpoint_interval == 0)
+        this->checkpoint_interval = saved_interval;
+
+    // Clock, state variables and statistical counters
+    if (!snapshot.get(this->simulationTime) || !snapshot.get(this->timeOfLastEvent) || !snapshot.get(this->num_custs_delayed) ||
+        !snapshot.get(this->num_in_q) || !snapshot.get(this->num_busy) || !snapshot.get(this->next_event_cust) ||
+        !snapshot.get(this->next_event_server) || !snapshot.get(this->curr_event_num) || !snapshot.get(this->num_departures) ||
+        !snapshot.get(this->area_num_in_q) || !snapshot.get(this->area_server_status) || !snapshot.get(this->total_of_delays))
+        return false;
+
+    // Queue and servers
+    if (!this->time_arrival.restore(snapshot) || !this->cust_in_q.restore(snapshot) || !snapshot.get(this->server_status) ||
+        !snapshot.get(this->server_cust) || !snapshot.get(this->idle_servers) || !snapshot.get(this->service_start) ||
+        !snapshot.get(this->server_busy_time))
+        return false;
+
+    // Pending events
+    if (!snapshot.get(events))
+        return false;
+    for (const Event &event : events)
+    {
+        if (event.type != 0 && (event.type != 1 || event.data < 0 || event.data >= this->num_servers))
+            return false;
+        this->eventList.schedule(event.time, event.type, event.data);
+    }
+
+    // Steady-state estimators
+    if (!this->delay_batches.restore(snapshot) || !snapshot.get(this->regenerative) || !snapshot.get(this->cycle_custs_delayed) ||
+        !snapshot.get(this->cycle_start) || !snapshot.get(this->cycle_total_of_delays) || !snapshot.get(this->cycle_area_num_in_q) ||
+        !snapshot.get(this->cycle_area_server_status))
+        return false;
+
+    // Generators; the samplers are set up as start() does, then moved to where they were
+    if (!snapshot.get(this->rand_gen))
+        return false;
+    this->interarrivals.init(this->rand_gen, this->mean_interarrival, this->sampling_mode, 1);
+    this->service_times.init(this->rand_gen, this->mean_service, this->sampling_mode, 2);
+    if (!this->interarrivals.restore(snapshot) || !this->service_times.restore(snapshot))
+        return false;
+
+    // The whole snapshot must have been read, and the servers must match their number
+    return snapshot.finished() && (int)this->server_status.size() == this->num_servers && (int)this->server_cust.size() == this->num_servers &&
+           (int)this->service_start.size() == this->num_servers && (int)this->server_busy_time.size() == this->num_servers &&
+           (int)this->time_arrival.size() == this->num_in_q && this->cust_in_q.size() == this->time_arrival.size();
+}
+
+void Simulation::compute_stats(SimulationStats &stats) const
+{
+    // Compute the measures of performance
+    stats.avg_delay = this->total_of_delays / this->num_custs_delayed;
+    stats.avg_num_in_q = this->area_num_in_q / this->simulationTime;
+    stats.server_utilization = this->area_server_status / (this->num_servers * this->simulationTime);
+    stats.time_end = this->simulationTime;
+}
+
+SimulationStatus Simulation::simulate(SimulationStats &stats)
+{
+    SimulationStatus status;
+
+    // Start from an empty and idle system; the generator carries on where it was
+    this->reset();
+    status = this->start();
+    if (status == SIMULATION_OK)
+        status = this->run_events();
+
+    if (status != SIMULATION_OK)
+    {
+        stats.avg_delay = stats.avg_num_in_q = stats.server_utilization = stats.time_end = std::numeric_limits<double>::quiet_NaN();
+        return status;
+    }
+
+    this->compute_stats(stats);
+
+    return SIMULATION_OK;
+}
+
+SimulationStatus Simulation::simulate_cycles(long num_cycles, RegenerativeStats &cycles)
+{
+    SimulationStatus status;
+
+    // cycles_required == 0 means a delay-count run, so no cycles is no run at all
+    this->reset();
+    if (num_cycles <= 0)
+    {
+        cycles = this->regenerative;
+        return SIMULATION_OK;
+    }
+
+    this->cycles_required = num_cycles;
+    status = this->start();
+    if (status == SIMULATION_OK)
+        status = this->run_events();
+    cycles = this->regenerative;
+
+    return status;
+}
+
+SimulationStatus Simulation::open_outputs(void)
+{
+    this->outFile1.open("out1.txt");
 
     if (!this->outFile1)
+        return SIMULATION_FILE_ERROR;
+
+    // open the trace file: binary for a full trace, text otherwise
+    if (this->trace_level == TRACE_FULL)
+    {
+        if (!this->trace_writer.open("out2.bin"))
+            return SIMULATION_FILE_ERROR;
+    }
+    else if (this->trace_level != TRACE_OFF)
     {
-        std::cout << "Error opening output file1\n";
-        exit(1);
+        this->outFile2.open("out2.txt");
+
+        if (!this->outFile2)
+            return SIMULATION_FILE_ERROR;
     }
 
-    // Read input parameters
-    this->inFile >> this->mean_interarrival >> this->mean_service >> this->num_delays_required;    
+    return SIMULATION_OK;
+}
 
+void Simulation::write_heading(void)
+{
     // Write report heading and input parameters
-    this->outFile1 << "Single-server queueing system\n\n";
+    if (this->num_servers == 1)
+        this->outFile1 << "Single-server queueing system\n\n";
+    else
+        this->outFile1 << "Multi-server queueing system\n\n";
     this->outFile1 << std::left << std::setw(30) << "Mean interarrival time:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << this->mean_interarrival << " minutes\n";
     this->outFile1 << std::left << std::setw(30) << "Mean service time:" << std::right << std::setw(10) << std::fixed << std::setprecision(3) << this->mean_service << " minutes\n";
     this->outFile1 << std::left << std::setw(30) << "Number of customers:" << std::right << std::setw(10) << this->num_delays_required << '\n';
+    if (this->num_servers > 1)
+        this->outFile1 << std::left << std::setw(30) << "Number of servers:" << std::right << std::setw(10) << this->num_servers << '\n';
+}
+
+SimulationStatus Simulation::close_outputs(SimulationStatus status, const SimulationStats &stats)
+{
+    // Invoke the report generator
+    if (status == SIMULATION_OK)
+        this->report(stats);
+
+    // Finish the trace
+    if (this->trace_level == TRACE_SUMMARY)
+        this->trace_summary();
+
+    // close output files
+    this->outFile1.close();
+    this->outFile2.close();
+    this->trace_writer.close();
+
+    return status;
+}
+
+SimulationStatus Simulation::run(SimulationEngine engine) {
+    SimulationParams params;
+    SimulationStats stats;
+    SimulationStatus status;
+
+    // A checkpoint holds the event-list state, and a resumed run cannot carry on a trace
+    if (this->checkpoint_interval > 0 && (engine == ENGINE_LINDLEY || this->trace_level == TRACE_TEXT || this->trace_level == TRACE_FULL))
+        return SIMULATION_CHECKPOINT_UNSUPPORTED;
+
+    this->inFile.open("in.txt");
+
+    if (!this->inFile)
+        return SIMULATION_FILE_ERROR;
+
+    // Read input parameters, and reject them before any output file is truncated
+    if (!read_params(this->inFile, params))
+        return SIMULATION_INVALID_PARAMS;
 
     // close input file
     this->inFile.close();
 
-    // Initialize the simulation
-    this->init_event_list();
+    if (engine == ENGINE_LINDLEY && params.num_servers != 1)
+        return SIMULATION_ENGINE_UNSUPPORTED;
 
-    // Run the simulation while more delays are still needed
-    while (this->num_custs_delayed < this->num_delays_required)
-    {
-        // Determine the next event
-        this->timing();
+    status = this->open_outputs();
+    if (status != SIMULATION_OK)
+        return status;
 
-        // Update time-average statistical accumulators
-        this->update_time_avg_stats();
+    this->mean_interarrival = params.mean_interarrival;
+    this->mean_service = params.mean_service;
+    this->num_delays_required = params.num_delays_required;
+    this->num_servers = params.num_servers;
 
-        // Invoke the appropriate event function
-        switch (this->next_event_type)
-        {
-        case 0:
-            this->arrive();
-            break;
-        case 1:
-            this->depart();
-            break;
-        default:
-            std::cout << "Error: next_event_type is invalid\n";
-            exit(1);
-        }
-    }
+    this->write_heading();
+
+    // Run the simulation
+    if (engine == ENGINE_LINDLEY)
+        status = simulate_lindley(params, this->rand_gen, stats);
+    else
+        status = this->simulate(stats);
 
-    // Invoke the report generator and end the simulation
-    this->report();
+    return this->close_outputs(status, stats);
+}
 
-    // close output files
-    this->outFile1.close();
-    this->outFile2.close();
+SimulationStatus Simulation::resume(const char *path)
+{
+    Snapshot snapshot;
+    SimulationStats stats;
+    SimulationStatus status;
+
+    // Restore the run, and keep checkpointing to the same file unless told otherwise
+    if (!snapshot.read_file(path) || !this->restore(snapshot))
+        return SIMULATION_CHECKPOINT_ERROR;
+    if (this->checkpoint_path.empty())
+        this->checkpoint_path = path;
+
+    status = this->open_outputs();
+    if (status != SIMULATION_OK)
+        return status;
+
+    this->write_heading();
+
+    // Carry on from the checkpoint
+    status = this->run_events();
+    if (status == SIMULATION_OK)
+        this->compute_stats(stats);
 
+    return this->close_outputs(status, stats);
 }
\ No newline at end of file
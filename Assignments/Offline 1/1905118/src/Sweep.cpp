@@ -0,0 +1,282 @@
+#include "../include/Sweep.h"
+#include "../include/Lindley.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+static const char *param_names[] = {"mean_interarrival", "mean_service", "num_delays_required", "num_servers"};
+
+static std::string trim(const std::string &s)
+{
+    size_t first = s.find_first_not_of(" \t\r"), last = s.find_last_not_of(" \t\r");
+    return first == std::string::npos ? "" : s.substr(first, last - first + 1);
+}
+
+// Parse all of text as a number
+static bool parse_number(const std::string &text, double &value)
+{
+    char *end;
+    std::string s = trim(text);
+
+    value = strtod(s.c_str(), &end);
+    return !s.empty() && *end == '\0' && std::isfinite(value);
+}
+
+// Parse "v1, v2, start:stop:step, ..." into values
+static bool parse_values(const std::string &text, std::vector<double> &values, std::string &error)
+{
+    std::stringstream list(text);
+    std::string item;
+
+    while (std::getline(list, item, ','))
+    {
+        size_t colon = item.find(':');
+        double start, stop, step;
+
+        if (colon == std::string::npos)
+        {
+            if (!parse_number(item, start))
+            {
+                error = "bad value \"" + trim(item) + "\"";
+                return false;
+            }
+            values.push_back(start);
+            continue;
+        }
+
+        size_t second = item.find(':', colon + 1);
+        if (second == std::string::npos || !parse_number(item.substr(0, colon), start) ||
+            !parse_number(item.substr(colon + 1, second - colon - 1), stop) || !parse_number(item.substr(second + 1), step))
+        {
+            error = "bad range \"" + trim(item) + "\", expected start:stop:step";
+            return false;
+        }
+        if (step == 0.0 || (stop - start) / step < 0.0 || (stop - start) / step > 1e6)
+        {
+            error = "range \"" + trim(item) + "\" does not reach its stop value";
+            return false;
+        }
+
+        // Values are start + i * step rather than a running sum, so they do not drift
+        long count = (long)std::floor((stop - start) / step + 1e-9) + 1;
+        for (long i = 0; i < count; ++i)
+            values.push_back(start + i * step);
+    }
+
+    if (values.empty())
+    {
+        error = "no values given";
+        return false;
+    }
+    return true;
+}
+
+static bool is_param(const std::string &name)
+{
+    for (const char *param : param_names)
+        if (name == param)
+            return true;
+    return false;
+}
+
+static void set_param(SimulationParams &params, const std::string &name, double value)
+{
+    if (name == "mean_interarrival")
+        params.mean_interarrival = value;
+    else if (name == "mean_service")
+        params.mean_service = value;
+    else if (name == "num_delays_required")
+        params.num_delays_required = (int)value;
+    else
+        params.num_servers = (int)value;
+}
+
+bool read_sweep(std::istream &in, SweepSpec &spec, std::string &error)
+{
+    std::string line, name, rest;
+    int line_num = 0;
+
+    spec.axes.clear();
+    spec.num_replications = 1;
+    spec.engine = ENGINE_EVENT_LIST;
+
+    while (std::getline(in, line))
+    {
+        ++line_num;
+        line = trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::stringstream words(line);
+        words >> name;
+        std::getline(words, rest);
+        rest = trim(rest);
+
+        std::string where = "line " + std::to_string(line_num) + ": ";
+        if (name == "replications")
+        {
+            double value;
+            if (!parse_number(rest, value) || value < 1.0 || value != std::floor(value))
+            {
+                error = where + "replications must be a positive whole number";
+                return false;
+            }
+            spec.num_replications = (int)value;
+        }
+        else if (name == "engine")
+        {
+            if (rest == "event_list")
+                spec.engine = ENGINE_EVENT_LIST;
+            else if (rest == "lindley")
+                spec.engine = ENGINE_LINDLEY;
+            else
+            {
+                error = where + "engine must be event_list or lindley";
+                return false;
+            }
+        }
+        else if (is_param(name))
+        {
+            SweepAxis axis;
+
+            for (const SweepAxis &other : spec.axes)
+            {
+                if (other.name == name)
+                {
+                    error = where + name + " is swept twice";
+                    return false;
+                }
+            }
+
+            axis.name = name;
+            if (!parse_values(rest, axis.values, error))
+            {
+                error = where + name + ": " + error;
+                return false;
+            }
+
+            // Means must be positive, counts positive whole numbers; SimulationParams
+            // holds the counts as int, which is their only limit
+            bool whole = name == "num_delays_required" || name == "num_servers";
+            for (double value : axis.values)
+            {
+                if (value <= 0.0 || (whole && value != std::floor(value)))
+                {
+                    error = where + name + (whole ? " must be positive whole numbers" : " must be positive");
+                    return false;
+                }
+                if (whole && value > std::numeric_limits<int>::max())
+                {
+                    error = where + name + " must be at most " + std::to_string(std::numeric_limits<int>::max());
+                    return false;
+                }
+            }
+
+            spec.axes.push_back(axis);
+        }
+        else
+        {
+            error = where + "unknown parameter " + name;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<SimulationParams> sweep_points(const SimulationParams &base, const SweepSpec &spec)
+{
+    std::vector<SimulationParams> points(1, base);
+
+    for (const SweepAxis &axis : spec.axes)
+    {
+        std::vector<SimulationParams> expanded;
+
+        expanded.reserve(points.size() * axis.values.size());
+        for (const SimulationParams &point : points)
+        {
+            for (double value : axis.values)
+            {
+                expanded.push_back(point);
+                set_param(expanded.back(), axis.name, value);
+            }
+        }
+        points.swap(expanded);
+    }
+
+    return points;
+}
+
+std::vector<SweepResult> run_sweep(ThreadPool &pool, const std::vector<SimulationParams> &points, const SweepSpec &spec,
+                                   SamplingMode sampling_mode)
+{
+    size_t num_replications = spec.num_replications;
+    std::vector<SimulationStats> runs(points.size() * num_replications);
+    std::vector<SweepResult> results(points.size());
+
+    // One job per replication of each point, so long points do not hold up a thread
+    pool.parallelFor(runs.size(), [&](size_t j) {
+        const SimulationParams &params = points[j / num_replications];
+        RandGen rand_gen = RandGen().substream(j % num_replications, num_replications);
+
+        if (spec.engine == ENGINE_LINDLEY)
+        {
+            simulate_lindley(params, rand_gen, runs[j]);
+        }
+        else
+        {
+            Simulation sim(params, rand_gen, sampling_mode);
+            sim.simulate(runs[j]);
+        }
+    });
+
+    for (size_t p = 0; p < points.size(); ++p)
+    {
+        results[p].params = points[p];
+        for (size_t r = 0; r < num_replications; ++r)
+        {
+            const SimulationStats &stats = runs[p * num_replications + r];
+
+            results[p].avg_delay.add(stats.avg_delay);
+            results[p].avg_num_in_q.add(stats.avg_num_in_q);
+            results[p].server_utilization.add(stats.server_utilization);
+            results[p].time_end.add(stats.time_end);
+        }
+    }
+
+    return results;
+}
+
+void write_sweep_csv(std::ostream &out, const std::vector<SweepResult> &results)
+{
+    const char *measures[] = {"avg_delay", "avg_num_in_q", "server_utilization", "time_end"};
+    bool intervals = !results.empty() && results[0].avg_delay.count() > 1;
+
+    out << "mean_interarrival,mean_service,num_delays_required,num_servers,replications";
+    for (const char *measure : measures)
+    {
+        out << ',' << measure;
+        if (intervals)
+            out << ',' << measure << "_hw";
+    }
+    out << '\n';
+
+    out << std::setprecision(10);
+    for (const SweepResult &result : results)
+    {
+        const RunningStat *stats[] = {&result.avg_delay, &result.avg_num_in_q, &result.server_utilization, &result.time_end};
+
+        out << result.params.mean_interarrival << ',' << result.params.mean_service << ','
+            << result.params.num_delays_required << ',' << result.params.num_servers << ',' << result.avg_delay.count();
+        for (const RunningStat *stat : stats)
+        {
+            out << ',' << stat->mean();
+            if (intervals)
+                out << ',' << confidenceInterval(*stat, 0.95).halfLength;
+        }
+        out << '\n';
+    }
+}
\ No newline at end of file
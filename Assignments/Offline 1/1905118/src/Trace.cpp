@@ -0,0 +1,92 @@
+#include "../include/Trace.h"
+
+#include <cstring>
+
+static const char trace_magic[8] = {'M', 'M', 'C', 'T', 'R', 'A', 'C', 'E'};
+
+TraceWriter::TraceWriter()
+{
+    this->count = 0;
+}
+
+TraceWriter::~TraceWriter()
+{
+    this->close();
+}
+
+bool TraceWriter::open(const char *path)
+{
+    unsigned record_size = sizeof(TraceRecord);
+
+    this->file.open(path, std::ios::binary);
+    if (!this->file)
+        return false;
+
+    // Header: magic, then the record size as a layout check
+    this->file.write(trace_magic, sizeof(trace_magic));
+    this->file.write(reinterpret_cast<const char *>(&record_size), sizeof(record_size));
+
+    this->buffer.resize(TRACE_BUFFER);
+    this->count = 0;
+
+    return true;
+}
+
+void TraceWriter::flush(void)
+{
+    this->file.write(reinterpret_cast<const char *>(this->buffer.data()), this->count * sizeof(TraceRecord));
+    this->count = 0;
+}
+
+void TraceWriter::close(void)
+{
+    if (this->file.is_open())
+    {
+        this->flush();
+        this->file.close();
+    }
+}
+
+void write_trace_text(std::ostream &out, long long event_num, int cust, int type, int num_custs_delayed)
+{
+    out << event_num << ". Next event: Customer " << cust << ((type & TRACE_DEPARTURE) ? " Departure\n" : " Arrival\n");
+
+    if (type & TRACE_BEGAN_SERVICE)
+        out << "\n---------No. of customers delayed: " << num_custs_delayed << "--------\n\n";
+}
+
+bool decode_trace(const char *in_path, const char *out_path)
+{
+    char magic[sizeof(trace_magic)];
+    unsigned record_size;
+    int num_custs_delayed = 0;
+    size_t i, n;
+    std::vector<TraceRecord> records(TRACE_BUFFER);
+    std::ifstream in(in_path, std::ios::binary);
+    std::ofstream out(out_path);
+
+    if (!in || !out)
+        return false;
+
+    // Check the header
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, trace_magic, sizeof(magic)) != 0)
+        return false;
+    if (!in.read(reinterpret_cast<char *>(&record_size), sizeof(record_size)) || record_size != sizeof(TraceRecord))
+        return false;
+
+    // Read the records a buffer at a time; the customers delayed are counted again from the flags
+    do
+    {
+        in.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(TraceRecord));
+        n = in.gcount() / sizeof(TraceRecord);
+
+        for (i = 0; i < n; ++i)
+        {
+            if (records[i].type & TRACE_BEGAN_SERVICE)
+                ++num_custs_delayed;
+            write_trace_text(out, records[i].event_num, records[i].cust, records[i].type, num_custs_delayed);
+        }
+    } while (n == records.size());
+
+    return true;
+}
\ No newline at end of file
@@ -1,10 +1,455 @@
 #include "../include/Simulation.h"
+#include "Replication.h"
+#include "Sequential.h"
+#include "Statistics.h"
+#include "lcgrand.h"
+#include "../include/Sweep.h"
 
-int main()
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+// Refuse to run num_replications replications whose streams would take more
+// than their share of the generator and overlap
+static void check_budget(double draws, size_t num_replications, SamplingMode mode)
 {
-    Simulation sim;
-    sim.run();
+    double budget = replicationBudget(RandGen(), num_replications, mode);
 
-    return 0;
+    if (draws > budget)
+    {
+        std::cout << "Error: a replication needs about " << draws << " random numbers per stream, but each of "
+                  << num_replications << " substreams holds " << budget
+                  << "; run fewer replications or build with -DRANDGEN_GENERATOR=Pcg64\n";
+        exit(1);
+    }
+}
+
+// Run independent replications of the model in in.txt on a thread pool and
+// write each replication with 95% confidence intervals to replications.txt
+void replicate(int num_replications, unsigned num_threads, SamplingMode mode)
+{
+    int r;
+    SimulationParams params;
+    RunningStat delay, num_in_q, utilization, time_end;
+    ConfidenceInterval ci;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("replications.txt");
+
+    if (!inFile || !outFile)
+    {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if (!Simulation::read_params(inFile, params))
+    {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    check_budget(Simulation::expected_draws(params, mode), num_replications, mode);
+
+    // Replication r runs on substream r, so the results do not depend on the number of threads
+    ThreadPool pool(num_threads);
+    std::vector<SimulationStats> results = runReplications<SimulationStats>(pool, num_replications, RandGen(), [&](const RandGen &rand_gen) {
+        SimulationStats stats;
+        Simulation sim(params, rand_gen, mode);
+        sim.simulate(stats);
+        return stats;
+    });
+
+    outFile << std::left << std::setw(15) << "Replication" << std::right << std::setw(15) << "Avg delay" << std::setw(15) << "Avg in queue" << std::setw(15) << "Utilization" << std::setw(15) << "Time ended" << '\n';
+    for (r = 0; r < num_replications; ++r)
+    {
+        outFile << std::left << std::setw(15) << (r + 1) << std::right << std::fixed << std::setprecision(3)
+                << std::setw(15) << results[r].avg_delay << std::setw(15) << results[r].avg_num_in_q
+                << std::setw(15) << results[r].server_utilization << std::setw(15) << results[r].time_end << '\n';
+
+        delay.add(results[r].avg_delay);
+        num_in_q.add(results[r].avg_num_in_q);
+        utilization.add(results[r].server_utilization);
+        time_end.add(results[r].time_end);
+    }
+
+    outFile << "\n" << std::left << std::setw(30) << "Measure" << std::right << std::setw(15) << "Mean" << std::setw(15) << "Variance" << std::setw(15) << "95% CI +/-" << '\n';
+    const char *names[] = {"Average delay in queue", "Average number in queue", "Server utilization", "Time simulation ended"};
+    const RunningStat *stats[] = {&delay, &num_in_q, &utilization, &time_end};
+    for (r = 0; r < 4; ++r)
+    {
+        ci = confidenceInterval(*stats[r], 0.95);
+        outFile << std::left << std::setw(30) << names[r] << std::right << std::fixed << std::setprecision(3)
+                << std::setw(15) << ci.mean << std::setw(15) << stats[r]->variance() << std::setw(15) << ci.halfLength << '\n';
+    }
+}
+
+// Add replications of the model in in.txt until the confidence interval for the
+// average delay meets rule, and write how the estimate tightened to sequential.txt
+void sequential(const StoppingRule &rule, SamplingMode mode)
+{
+    size_t n, report_at;
+    SimulationParams params;
+    RunningStat delay;
+    ConfidenceInterval ci;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("sequential.txt");
+
+    if (!inFile || !outFile)
+    {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if (!Simulation::read_params(inFile, params))
+    {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    check_budget(Simulation::expected_draws(params, mode), rule.maxRuns, mode);
+
+    ThreadPool pool;
+    SequentialRun<SimulationStats> run = runSequential<SimulationStats>(pool, rule, RandGen(), [&](const RandGen &rand_gen) {
+        SimulationStats stats;
+        Simulation sim(params, rand_gen, mode);
+        sim.simulate(stats);
+        return stats;
+    }, [](const SimulationStats &stats) {
+        return std::vector<double>(1, stats.avg_delay);
+    });
+
+    outFile << (rule.target == PRECISION_ABSOLUTE ? "Absolute error beta: " : "Relative error gamma: ") << rule.precision
+            << ", confidence: " << rule.confidence << "\n\n";
+    outFile << std::left << std::setw(10) << "Runs" << std::right << std::setw(15) << "Mean" << std::setw(15) << "Std dev"
+            << std::setw(15) << "Variance" << std::setw(15) << "Half-length" << std::setw(15) << "Half/mean" << '\n';
+
+    // Show the estimate of the average delay at n0, 2 * n0, 4 * n0, ... and at the stopping point
+    report_at = rule.minRuns;
+    for (n = 1; n <= run.results.size(); ++n)
+    {
+        delay.add(run.results[n - 1].avg_delay);
+        if (n != report_at && n != run.results.size())
+            continue;
+        if (n == report_at)
+            report_at *= 2;
+
+        ci = confidenceInterval(delay, rule.confidence);
+        outFile << std::left << std::setw(10) << n << std::right << std::fixed << std::setprecision(5)
+                << std::setw(15) << ci.mean << std::setw(15) << std::sqrt(delay.variance()) << std::setw(15) << delay.variance()
+                << std::setw(15) << ci.halfLength << std::setw(15) << ci.halfLength / std::fabs(ci.mean) << '\n';
+    }
+
+    outFile << '\n' << (run.converged ? "Target met" : "Target not met") << " after " << run.results.size() << " runs\n";
+}
+
+// Write one estimate with its half-length in the layout of out1.txt
+static void write_interval(std::ofstream &outFile, const char *name, const ConfidenceInterval &ci)
+{
+    outFile << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(5)
+            << std::setw(12) << ci.mean << " +/- " << std::setw(10) << ci.halfLength << '\n';
+}
+
+static void write_regenerative(std::ofstream &outFile, const RegenerativeStats &regenerative)
+{
+    outFile << "Regenerative method, " << regenerative.delay.count() << " cycles ending when the system empties\n";
+    write_interval(outFile, "Average delay in queue:", confidenceInterval(regenerative.delay, 0.95));
+    write_interval(outFile, "Average number in queue:", confidenceInterval(regenerative.num_in_q, 0.95));
+    write_interval(outFile, "Server utilization:", confidenceInterval(regenerative.utilization, 0.95));
+}
+
+// Run the model in in.txt once and write steady-state estimates with 95%
+// confidence intervals from batch means and from regeneration cycles to steady.txt
+void steady(SamplingMode mode)
+{
+    SimulationParams params;
+    SimulationStats stats;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("steady.txt");
+
+    if (!inFile || !outFile)
+    {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if (!Simulation::read_params(inFile, params))
+    {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    Simulation sim(params, RandGen(), mode);
+    sim.simulate(stats);
+    const BatchMeans &batches = sim.delay_batch_means();
+
+    outFile << "Steady-state estimates from one run of " << params.num_delays_required << " customers, 95% confidence\n\n";
+    outFile << std::left << std::setw(30) << "Average delay in queue:" << std::right << std::fixed << std::setprecision(5) << std::setw(12) << stats.avg_delay << '\n';
+    outFile << std::left << std::setw(30) << "Average number in queue:" << std::right << std::setw(12) << stats.avg_num_in_q << '\n';
+    outFile << std::left << std::setw(30) << "Server utilization:" << std::right << std::setw(12) << stats.server_utilization << "\n\n";
+
+    outFile << "Batch means, " << batches.numberOfBatches() << " batches of " << batches.batchSize() << " delays, lag-1 correlation "
+            << std::setprecision(3) << batches.lag1Correlation() << '\n';
+    write_interval(outFile, "Average delay in queue:", confidenceInterval(batches, 0.95));
+    outFile << '\n';
+
+    write_regenerative(outFile, sim.regenerative_stats());
+}
+
+// Simulate num_cycles regeneration cycles as independent pieces on a thread
+// pool and write the pooled estimates to regenerative.txt
+void regenerative(long num_cycles, unsigned num_threads, SamplingMode mode)
+{
+    const long num_pieces = std::min<long>(64, num_cycles);
+    SimulationParams params;
+    RegenerativeStats total;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("regenerative.txt");
+
+    if (!inFile || !outFile)
+    {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if (!Simulation::read_params(inFile, params))
+    {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    // Cycles are independent and identically distributed, so a fixed number of
+    // pieces, each on its own substream, gives the same answer on any number of
+    // threads; every piece runs at least one cycle
+    ThreadPool pool(num_threads);
+    std::vector<RegenerativeStats> pieces(num_pieces);
+    pool.parallelFor(num_pieces, [&](size_t i) {
+        Simulation sim(params, RandGen().substream(i, num_pieces), mode);
+        sim.simulate_cycles(num_cycles / num_pieces + ((long)i < num_cycles % num_pieces ? 1 : 0), pieces[i]);
+    });
+
+    for (const RegenerativeStats &piece : pieces)
+        total.merge(piece);
+
+    outFile << "Steady-state estimates from independent regeneration cycles, 95% confidence\n\n";
+    write_regenerative(outFile, total);
 }
 
+// Run every point of the sweep in spec_file, other parameters coming from
+// in.txt, and write one CSV row per point to sweep.csv
+void sweep(const char *spec_file, unsigned num_threads, SamplingMode mode)
+{
+    SimulationParams base;
+    SweepSpec spec;
+    std::string error;
+    std::ifstream inFile("in.txt"), specFile(spec_file);
+    std::ofstream outFile("sweep.csv");
+
+    if (!inFile || !specFile || !outFile)
+    {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if (!Simulation::read_params(inFile, base))
+    {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    if (!read_sweep(specFile, spec, error))
+    {
+        std::cout << "Error in " << spec_file << ", " << error << "\n";
+        exit(1);
+    }
+
+    // The lindley engine always draws from batched substreams
+    std::vector<SimulationParams> points = sweep_points(base, spec);
+    SamplingMode stream_mode = spec.engine == ENGINE_LINDLEY ? SAMPLING_BATCHED : mode;
+    double draws = 0.0;
+    for (const SimulationParams &point : points)
+    {
+        if (spec.engine == ENGINE_LINDLEY && point.num_servers != 1)
+        {
+            std::cout << "Error: the lindley engine only runs single-server models\n";
+            exit(1);
+        }
+        draws = std::max(draws, Simulation::expected_draws(point, stream_mode));
+    }
+    check_budget(draws, spec.num_replications, stream_mode);
+
+    ThreadPool pool(num_threads);
+    write_sweep_csv(outFile, run_sweep(pool, points, spec, mode));
+}
+
+// Whether arg is one of the options read by main, rather than a mode argument
+static bool is_option(const char *arg)
+{
+    return strcmp(arg, "batched") == 0 || strchr(arg, '=') != nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    // "batched" draws variates in blocks instead of reproducing the reference output;
+    // "trace=off|summary|full|text" picks the trace level, text being the coursework trace;
+    // "checkpoint=N" saves the run to checkpoint.bin every N events (see resume below)
+    SamplingMode mode = SAMPLING_REFERENCE;
+    TraceLevel trace_level = TRACE_TEXT;
+    long long checkpoint_interval = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "batched") == 0)
+            mode = SAMPLING_BATCHED;
+        else if (strcmp(argv[i], "trace=off") == 0)
+            trace_level = TRACE_OFF;
+        else if (strcmp(argv[i], "trace=summary") == 0)
+            trace_level = TRACE_SUMMARY;
+        else if (strcmp(argv[i], "trace=full") == 0)
+            trace_level = TRACE_FULL;
+        else if (strcmp(argv[i], "trace=text") == 0)
+            trace_level = TRACE_TEXT;
+        else if (strncmp(argv[i], "checkpoint=", 11) == 0)
+            checkpoint_interval = atoll(argv[i] + 11);
+    }
+
+    // "replicate N [threads]" runs N independent replications instead of a single run
+    if (argc > 2 && strcmp(argv[1], "replicate") == 0)
+    {
+        int num_replications = atoi(argv[2]);
+        unsigned num_threads = (argc > 3 && isdigit((unsigned char)argv[3][0])) ? (unsigned)atoi(argv[3]) : 0;
+
+        if (num_replications < 2)
+        {
+            std::cout << "Error: at least 2 replications are needed\n";
+            exit(1);
+        }
+
+        replicate(num_replications, num_threads, mode);
+        return 0;
+    }
+
+    // "sequential abs|rel <precision> [confidence]" runs until the average delay is that precise
+    if (argc > 3 && strcmp(argv[1], "sequential") == 0)
+    {
+        StoppingRule rule;
+
+        rule.target = strcmp(argv[2], "rel") == 0 ? PRECISION_RELATIVE : PRECISION_ABSOLUTE;
+        rule.precision = atof(argv[3]);
+        rule.confidence = (argc > 4 && isdigit((unsigned char)argv[4][0])) ? atof(argv[4]) : 0.95;
+        rule.minRuns = 10;
+        rule.maxRuns = 10000;
+
+        if (rule.precision <= 0.0 || rule.confidence <= 0.0 || rule.confidence >= 1.0)
+        {
+            std::cout << "Error: invalid precision or confidence\n";
+            exit(1);
+        }
+
+        sequential(rule, mode);
+        return 0;
+    }
+
+    // "steady" writes batch-means and regenerative intervals for one run of in.txt
+    if (argc > 1 && strcmp(argv[1], "steady") == 0)
+    {
+        steady(mode);
+        return 0;
+    }
+
+    // "regenerative <cycles> [threads]" simulates that many cycles in parallel
+    if (argc > 2 && strcmp(argv[1], "regenerative") == 0)
+    {
+        long num_cycles = atol(argv[2]);
+        unsigned num_threads = (argc > 3 && isdigit((unsigned char)argv[3][0])) ? (unsigned)atoi(argv[3]) : 0;
+
+        if (num_cycles < 2)
+        {
+            std::cout << "Error: at least 2 cycles are needed\n";
+            exit(1);
+        }
+
+        regenerative(num_cycles, num_threads, mode);
+        return 0;
+    }
+
+    // "sweep <spec> [threads]" runs a grid of parameter values (see Sweep.h)
+    if (argc > 2 && strcmp(argv[1], "sweep") == 0)
+    {
+        unsigned num_threads = (argc > 3 && isdigit((unsigned char)argv[3][0])) ? (unsigned)atoi(argv[3]) : 0;
+
+        sweep(argv[2], num_threads, mode);
+        return 0;
+    }
+
+    // "resume [file]" carries on a checkpointed run, by default from checkpoint.bin,
+    // and checkpoints it again at its own interval unless checkpoint=N is given
+    if (argc > 1 && strcmp(argv[1], "resume") == 0)
+    {
+        const char *path = (argc > 2 && !is_option(argv[2])) ? argv[2] : CHECKPOINT_FILE;
+        Simulation sim(mode, trace_level);
+
+        if (checkpoint_interval > 0)
+            sim.set_checkpoint(path, checkpoint_interval);
+
+        SimulationStatus status = sim.resume(path);
+        if (status != SIMULATION_OK)
+        {
+            std::cout << "Error: " << simulation_status_message(status) << "\n";
+            exit(1);
+        }
+        return 0;
+    }
+
+    // "decode [in] [out]" turns a binary trace back into the text trace
+    if (argc > 1 && strcmp(argv[1], "decode") == 0)
+    {
+        if (!decode_trace(argc > 2 ? argv[2] : "out2.bin", argc > 3 ? argv[3] : "out2.txt"))
+        {
+            std::cout << "Error: cannot decode trace\n";
+            exit(1);
+        }
+        return 0;
+    }
+
+    // "checkfill" compares every supported lcgrandfill block path with plain lcgrand calls
+    if (argc > 1 && strcmp(argv[1], "checkfill") == 0)
+    {
+        const LcgFillPath paths[] = {LCGFILL_SCALAR, LCGFILL_SSE2, LCGFILL_AVX2};
+        const char *path_names[] = {"scalar", "SSE2", "AVX2"};
+        bool passed = true;
+
+        for (int p = 0; p < 3; ++p)
+        {
+            if (!lcgrandfillsupported(paths[p]))
+                std::cout << path_names[p] << ": not supported\n";
+            else if (lcgrandfillcheck(paths[p]))
+                std::cout << path_names[p] << ": ok\n";
+            else
+            {
+                std::cout << path_names[p] << ": MISMATCH\n";
+                passed = false;
+            }
+        }
+        return passed ? 0 : 1;
+    }
+
+    // "lindley" runs the single-server model through the Lindley recursion instead of the event list
+    SimulationEngine engine = ENGINE_EVENT_LIST;
+    if (argc > 1 && strcmp(argv[1], "lindley") == 0)
+        engine = ENGINE_LINDLEY;
+
+    Simulation sim(mode, trace_level);
+    if (checkpoint_interval > 0)
+        sim.set_checkpoint(CHECKPOINT_FILE, checkpoint_interval);
+
+    SimulationStatus status = sim.run(engine);
+    if (status != SIMULATION_OK)
+    {
+        std::cout << "Error: " << simulation_status_message(status) << "\n";
+        exit(1);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef AGGREGATEDDEMAND_H
+#define AGGREGATEDDEMAND_H
+
+#include <vector>
+#include "RandGen.h"
+#include "../include/Simulation.h"
+
+// Event-free engine for the (s,S) model.  Only evaluations, order arrivals and
+// the end of the simulation change the state other than by demand, so between
+// two of them the demands form a compound Poisson block: over an interval of
+// length L their number N is Poisson(L / meanInterDemandTime), and given N
+// their times are N sorted uniforms on the interval.  A block is drawn as N and
+// N demand sizes, without the times.  The inventory passes through N + 1
+// levels I(0), ..., I(N), and each lasts L / (N + 1) on average (the mean
+// spacing of uniform order statistics), so the areas are integrated as
+//
+//     hold     += L / (N + 1) * sum of max(I(k), 0)
+//     shortage += L / (N + 1) * sum of max(-I(k), 0)
+//
+// which is the event-driven area averaged over the demand times: the same
+// expectation with less variance.  The levels, orders and ordering cost have
+// the same distribution as in the event-driven model.  A month costs a Poisson
+// draw and a pass over a block of uniforms for the sizes, rather than an event
+// list operation per demand.
+//
+// As in the event-driven model, an order placed while one is outstanding
+// replaces it, and an order due at an evaluation arrives before it.
+class AggregatedDemand
+{
+public:
+    AggregatedDemand(const InventoryParams &params, const RandGen &randGen);
+
+    // One policy, or every policy in turn on the one stream
+    SimulationStatus simulatePolicy(int smalls, int bigs, PolicyResult &result);
+    std::vector<PolicyResult> simulate(void);
+
+private:
+    void demandBlock(double length);
+
+    InventoryParams params;                            // Model and policies
+    SimulationStatus status;                           // Outcome of checking params
+    RandGen randGen;                                   // Random number generator
+    GuideTable demandSizes;                            // Guide table over the demand distribution
+    std::vector<double> uniforms;                      // Uniforms of the current block's sizes
+
+    int inventoryLevel;                                // Current inventory level
+    double areaUnderHoldCurve;                         // Area under the positive inventory level
+    double areaUnderShortageCurve;                     // Area under the backlog
+};
+
+#endif // AGGREGATEDDEMAND_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef POLICYBATCH_H
+#define POLICYBATCH_H
+
+#include <vector>
+#include "RandGen.h"
+#include "../include/Simulation.h"
+
+#define POLICYBATCH_CHUNK 1024                         // Policies advanced together over the trajectory
+
+// Lockstep evaluation of many (s,S) policies under common random numbers.
+// One demand trajectory (inter-demand times and sizes) is drawn and every
+// policy is advanced through it, with the inventory state held as a
+// structure of arrays so each demand updates all policies in one SIMD pass.
+// Delivery lags are still drawn per policy, from substream i of a lag
+// stream, so a policy's results do not depend on which others run with it.
+//
+// Each policy follows the event-driven model: an order placed while one is
+// outstanding replaces it, and events at the same time are taken in the
+// order order arrival, demand, end of simulation, evaluation.
+class PolicyBatch
+{
+public:
+    PolicyBatch(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode = SAMPLING_REFERENCE);
+    std::vector<PolicyResult> simulate(void);
+
+private:
+    void drawTrajectory(void);
+    void simulateChunk(size_t first, size_t count);
+    void evaluate(size_t first, size_t count, double time);
+
+    InventoryParams params;                            // Model and policies
+    SamplingMode samplingMode;                         // How inter-demand times are drawn
+    RandGen demandGen;                                 // Stream shared by every policy's demands
+    RandGen lagGen;                                    // Parent of the per-policy lag streams
+    GuideTable demandSizes;                            // Guide table over the demand distribution
+
+    std::vector<double> demandTimes;                   // Demand times of the shared trajectory
+    std::vector<double> demandAmounts;                 // Demand sizes of the shared trajectory
+
+    std::vector<RandGen> lagStreams;                   // Delivery lag stream of each policy
+    std::vector<double> inventoryLevel;                // Current inventory level of each policy
+    std::vector<double> orderArrival;                  // Arrival time of the outstanding order, or infinity
+    std::vector<double> orderAmount;                   // Size of the outstanding order
+    std::vector<double> areaUnderHoldCurve;            // Area under the positive inventory level
+    std::vector<double> areaUnderShortageCurve;        // Area under the backlog
+    std::vector<double> totalOrderingCost;             // Total ordering cost of each policy
+};
+
+// Advance n policies from time prev to time, taking any order arrival due by
+// then, and remove a demand of size amount (0 for a bare time step)
+void policyBatchStep(double prev, double time, double amount, size_t n, double *inventoryLevel, double *orderArrival,
+                     const double *orderAmount, double *areaUnderHoldCurve, double *areaUnderShortageCurve);
+
+#endif // POLICYBATCH_H
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "RandGen.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+// Ranking and selection of the system with the least mean by the fully
+// sequential procedure KN of Kim and Nelson (2001).  Every system gets n0
+// replications; from then on, one more per stage for each system still in
+// contention, and a system is dropped as soon as its mean exceeds another's by
+// more than the continuation region allows,
+//
+//     W(i, l, r) = max(0, delta / (2r) * (h^2 S^2(i, l) / delta^2 - r))
+//
+// where S^2(i, l) is the first-stage variance of the differences between i and
+// l, and h^2 = (n0 - 1) ((2 alpha / (k - 1))^(-2 / (n0 - 1)) - 1).  The system
+// left is the best with probability at least 1 - alpha whenever the best mean
+// is at least delta (the indifference zone) below all the others.
+//
+// Replication r of every system uses substream r of base, so the systems are
+// compared under common random numbers and the differences screened on have
+// less variance.  Replications run a round of stages at a time on the pool, but
+// screening is applied stage by stage in order and later replications of a
+// dropped system are discarded, so the outcome does not depend on the number
+// of threads.
+
+struct SelectionRule {
+    double indifference;                               // delta, the smallest difference worth detecting
+    double confidence;                                 // 1 - alpha, the probability of correct selection
+    size_t firstStage;                                 // n0, replications of every system before screening, at least 2
+    size_t maxRuns;                                    // Give up after this many stages and take the least mean
+};
+
+struct SelectionRun {
+    size_t best;                                       // Index of the selected system
+    bool resolved;                                     // Whether one system was left before maxRuns
+    size_t stages;                                     // Stages run
+    double h2;                                         // h^2 of the continuation region
+    std::vector<RunningStat> stats;                    // Replications of each system while it was in contention
+    std::vector<size_t> dropped;                       // Stage each system was dropped at, 0 if never
+};
+
+// Screening at stage r: drop every contender that another contender beats by
+// more than W, recording the stage it was dropped at
+inline void screenContenders(SelectionRun &run, const std::vector<double> &variance, double delta, size_t stage, std::vector<size_t> &contenders) {
+    size_t k = run.stats.size();
+    std::vector<size_t> survivors;
+
+    for(size_t i : contenders) {
+        bool keep = true;
+
+        for(size_t l : contenders) {
+            double w = std::max(0.0, delta / (2.0 * stage) * (run.h2 * variance[i * k + l] / (delta * delta) - stage));
+            keep = keep && (l == i || run.stats[i].mean() <= run.stats[l].mean() + w);
+        }
+        if(keep) {
+            survivors.push_back(i);
+        } else {
+            run.dropped[i] = stage;
+        }
+    }
+
+    contenders.swap(survivors);
+}
+
+// Select among numberOfSystems systems.  simulate(i, randGen) runs one
+// replication of system i and returns the value to be minimized.
+template <class Simulate>
+SelectionRun runKimNelson(ThreadPool &pool, const SelectionRule &rule, size_t numberOfSystems, const RandGen &base, Simulate simulate) {
+    size_t k = numberOfSystems, n0 = rule.firstStage, stage = n0;
+    std::vector<double> firstStage(k * n0), variance(k * k, 0.0), round;
+    std::vector<size_t> contenders;
+    SelectionRun run;
+
+    run.stats.assign(k, RunningStat());
+    run.dropped.assign(k, 0);
+    run.h2 = k > 1 ? (n0 - 1) * (std::pow(2.0 * (1.0 - rule.confidence) / (k - 1), -2.0 / (n0 - 1)) - 1.0) : 0.0;
+
+    // First stage: n0 replications of every system
+    pool.parallelFor(k * n0, [&](size_t j) {
+        firstStage[j] = simulate(j / n0, base.substream(j % n0, rule.maxRuns));
+    });
+    for(size_t i = 0; i < k; i++) {
+        run.stats[i].addBlock(&firstStage[i * n0], n0);
+        contenders.push_back(i);
+    }
+
+    // Variance of the differences of each pair over the first stage
+    for(size_t i = 0; i < k; i++) {
+        for(size_t l = i + 1; l < k; l++) {
+            double meanDifference = run.stats[i].mean() - run.stats[l].mean(), sum = 0.0;
+
+            for(size_t r = 0; r < n0; r++) {
+                double deviation = firstStage[i * n0 + r] - firstStage[l * n0 + r] - meanDifference;
+                sum += deviation * deviation;
+            }
+            variance[i * k + l] = variance[l * k + i] = sum / (n0 - 1);
+        }
+    }
+
+    screenContenders(run, variance, rule.indifference, stage, contenders);
+    while(contenders.size() > 1 && stage < rule.maxRuns) {
+        // Run enough stages at once to keep the pool busy
+        std::vector<size_t> systems = contenders;
+        size_t count = std::min((2 * pool.size() + systems.size() - 1) / systems.size(), rule.maxRuns - stage);
+        size_t first = stage;
+
+        round.assign(count * systems.size(), 0.0);
+        pool.parallelFor(round.size(), [&](size_t j) {
+            round[j] = simulate(systems[j % systems.size()], base.substream(first + j / systems.size(), rule.maxRuns));
+        });
+
+        // Screen the stages in order, ignoring the replications of systems already dropped
+        for(size_t s = 0; s < count && contenders.size() > 1; s++) {
+            for(size_t c = 0; c < systems.size(); c++) {
+                if(run.dropped[systems[c]] == 0) {
+                    run.stats[systems[c]].add(round[s * systems.size() + c]);
+                }
+            }
+            stage++;
+            screenContenders(run, variance, rule.indifference, stage, contenders);
+        }
+    }
+
+    // The one left, or the least mean among those left at maxRuns
+    run.stages = stage;
+    run.resolved = contenders.size() == 1;
+    run.best = contenders[0];
+    for(size_t i : contenders) {
+        if(run.stats[i].mean() < run.stats[run.best].mean()) {
+            run.best = i;
+        }
+    }
+
+    return run;
+}
+
+#endif // SELECTION_H
\ No newline at end of file
@@ -1,37 +1,121 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
-#define INF 1.0e+30
-
 #include <fstream>
+#include <istream>
+#include <utility>
 #include <vector>
-#include "../include/RandGen.h"
+#include "EventKernel.h"
+#include "RandGen.h"
+#include "ThreadPool.h"
+
+// Model parameters and the (s,S) policies to evaluate, as read from in.txt
+struct InventoryParams {
+    int initialInventoryLevel;                         // Initial inventory level
+    int numberOfMonths;                                // Number of months to simulate
+    double meanInterDemandTime;                        // Mean interdemand time
+    double setupCost;                                  // Setup cost
+    double incrementalCost;                            // Incremental cost
+    double holdingCost;                                // Holding cost
+    double shortageCost;                               // Shortage cost
+    double minArrivalLag;                              // Minimum arrival lag
+    double maxArrivalLag;                              // Maximum arrival lag
+    std::vector<double> demandCumulativeProbabilities; // Demand cumulative probability
+    std::vector<std::pair<int, int>> policies;         // (smalls, bigs) of each policy
+};
+
+// Outcome of a run; the library calls return it instead of exiting
+enum SimulationStatus {
+    SIMULATION_OK,
+    SIMULATION_INVALID_PARAMS,                         // Parameters missing or out of range
+    SIMULATION_EVENT_LIST_EMPTY,                       // No event was left to process
+    SIMULATION_FILE_ERROR                              // in.txt or out.txt could not be opened (front-end only)
+};
 
-class Simulation
+// Text for status, for front-ends to show
+const char *statusMessage(SimulationStatus status);
+
+// How run() evaluates the policies in in.txt
+enum PolicyEvaluation {
+    EVALUATE_SERIAL,                                   // One after another on one stream, the reference output
+    EVALUATE_PARALLEL,                                 // Concurrently, each policy on its own stream
+    EVALUATE_LOCKSTEP,                                 // All at once on one shared demand trajectory
+    EVALUATE_AGGREGATED                                // One after another, demand drawn a block per interval between events
+};
+
+// Average monthly costs of one policy, as written by report()
+struct PolicyResult {
+    int smalls;                                        // Reorder point
+    int bigs;                                          // Order-up-to level
+    double avgTotalCost;                               // Average total cost
+    double avgOrderingCost;                            // Average ordering cost
+    double avgHoldingCost;                             // Average holding cost
+    double avgShortageCost;                            // Average shortage cost
+};
+
+class Simulation : public EventKernel<Simulation, 4>
 {
+    friend class EventKernel<Simulation, 4>;
+
 public:
-    Simulation();
+    // File front-end: run() reads in.txt and writes out.txt
+    Simulation(SamplingMode samplingMode = SAMPLING_REFERENCE);
+
+    // In-process use: setup() takes the model and generator, and simulate()
+    // evaluates every policy in turn on randGen and returns their costs without
+    // touching any file.  An object can be set up again for another model and
+    // keeps its event list and demand table storage.  The constructor with
+    // parameters calls setup(); a failed setup is returned by simulate().
+    Simulation(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode = SAMPLING_REFERENCE);
+    SimulationStatus setup(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode = SAMPLING_REFERENCE);
+    SimulationStatus simulate(std::vector<PolicyResult> &results);
+
+    // Evaluate the policies concurrently on pool.  Policy i gets its own
+    // Simulation and substream i of randGen, so the results are the same
+    // however many threads run them; they come back in the order of params.policies
+    static SimulationStatus simulatePolicies(ThreadPool &pool, const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode,
+                                             std::vector<PolicyResult> &results);
+
+    // Read parameters in the in.txt format; false if they are missing or invalid
+    static bool readParams(std::istream &in, InventoryParams &params);
+    static SimulationStatus checkParams(const InventoryParams &params);
+
+    // Uniforms the busiest stream of simulate() is expected to take, over every
+    // policy in params or one if there are none, to check against a
+    // replication's budget (see Replication.h)
+    static double expectedDraws(const InventoryParams &params, SamplingMode samplingMode);
+
     void initialize(void);
-    void timing(void);
     void orderArrival(void);
     void demand(void);
     void evaluate(void);
-    void report(void);
-    void updateTimeAvgStats(void);
-    void run();
+    SimulationStatus simulatePolicy(int smalls, int bigs, PolicyResult &result);
+    void report(const PolicyResult &result);
+    void updateTimeAvgStats(double timeSinceLastEvent);
+
+    // numberOfThreads is used by EVALUATE_PARALLEL, 0 for one per core
+    SimulationStatus run(PolicyEvaluation evaluation = EVALUATE_SERIAL, unsigned numberOfThreads = 0);
 private:
+    void setParams(const InventoryParams &params);
+    void prepare(void);
+
+    // Event kernel hooks: 0 order arrival, 1 demand, 2 end of simulation, 3 evaluation
+    bool done(void) const { return this->ended; }
+    void accumulate(double elapsed) { this->updateTimeAvgStats(elapsed); }
+    void handle(EventType<0>, const Event &) { this->orderArrival(); }
+    void handle(EventType<1>, const Event &) { this->demand(); }
+    void handle(EventType<2>, const Event &) { this->ended = true; }
+    void handle(EventType<3>, const Event &) { this->evaluate(); }
+
     int initialInventoryLevel;                         // Initial inventory level
     int currentInventoryLevel;                         // Current inventory level
     int numberOfMonths;                                // Number of months to simulate
     int numberOfPolicies;                              // Number of policies
-    int numberOfEvents;                                // Number of events
     int numberOfDemandValues;                          // Number of demand values
     int smalls;                                        // Number of smalls
     int bigs;                                          // Number of bigs
     int orderAmount;                                   // Order amount
-    int nextEventType;                                 // Next event type
-    double simulationTime;                             // Simulation time
-    double timeOfLastEvent;                            // Time of last event
+    bool ended;                                        // Whether the end of simulation event has occurred
     double meanInterDemandTime;                        // Mean interdemand time
     double setupCost;                                  // Setup cost
     double incrementalCost;                            // Incremental cost
@@ -44,12 +128,17 @@ private:
     double maxArrivalLag;                              // Maximum arrival lag
 
     std::vector<double> demandCumulativeProbabilities; // Demand cumulative probability
-    std::vector<double> timeOfNextEvents;              // Time of next events
+    std::vector<std::pair<int, int>> policies;         // (smalls, bigs) of each policy
+    GuideTable demandSizes;                            // Guide table over demandCumulativeProbabilities
+    int orderArrivalEvent;                             // Handle of the pending order arrival, if any
 
     std::ifstream inFile;                              // Input file
     std::ofstream outFile;                             // Output file
 
     RandGen randGen;                                   // Random number generator
+    SamplingMode samplingMode;                         // How variates are drawn from randGen
+    SimulationStatus status;                           // Outcome of setup()
+    ExponentialBuffer interDemandTimes;                // Inter-demand time variates
 };
 
 #endif // SIMULATION_H
\ No newline at end of file
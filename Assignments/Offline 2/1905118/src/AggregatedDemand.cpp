@@ -0,0 +1,92 @@
+#include "../include/AggregatedDemand.h"
+
+#include <algorithm>
+#include <limits>
+
+AggregatedDemand::AggregatedDemand(const InventoryParams &params, const RandGen &randGen)
+    : params(params), status(Simulation::checkParams(params)), randGen(randGen)
+{
+    if(this->status == SIMULATION_OK) {
+        this->demandSizes.build(this->params.demandCumulativeProbabilities);
+    }
+}
+
+void AggregatedDemand::demandBlock(double length)
+{
+    if(length <= 0.0) {
+        return;
+    }
+
+    long n = this->randGen.getPoisson(length / this->params.meanInterDemandTime);
+    double positive = std::max(this->inventoryLevel, 0), negative = std::max(-this->inventoryLevel, 0);
+
+    this->uniforms.resize(n);
+    this->randGen.getUniformBlock(this->uniforms.data(), n);
+
+    // Sum the level before and after each demand
+    for(long k = 0; k < n; k++) {
+        this->inventoryLevel -= this->demandSizes.lookup(this->uniforms[k]);
+        positive += std::max(this->inventoryLevel, 0);
+        negative += std::max(-this->inventoryLevel, 0);
+    }
+
+    this->areaUnderHoldCurve += length / (n + 1) * positive;
+    this->areaUnderShortageCurve += length / (n + 1) * negative;
+}
+
+SimulationStatus AggregatedDemand::simulatePolicy(int smalls, int bigs, PolicyResult &result)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    double orderArrival = infinity, totalOrderingCost = 0.0;
+    int orderAmount = 0;
+
+    result.smalls = smalls;
+    result.bigs = bigs;
+    result.avgTotalCost = result.avgOrderingCost = result.avgHoldingCost = result.avgShortageCost = std::numeric_limits<double>::quiet_NaN();
+    if(this->status != SIMULATION_OK) {
+        return this->status;
+    }
+
+    this->inventoryLevel = this->params.initialInventoryLevel;
+    this->areaUnderHoldCurve = 0.0;
+    this->areaUnderShortageCurve = 0.0;
+
+    for(int month = 0; month < this->params.numberOfMonths; month++) {
+        double time = month;
+
+        // Evaluate, replacing any order still outstanding
+        if(this->inventoryLevel < smalls) {
+            orderAmount = bigs - this->inventoryLevel;
+            totalOrderingCost += this->params.setupCost + this->params.incrementalCost * orderAmount;
+            orderArrival = month + this->randGen.getUniform(this->params.minArrivalLag, this->params.maxArrivalLag);
+        }
+
+        // Demands up to an order arriving this month, then the rest of the month
+        if(orderArrival <= month + 1) {
+            this->demandBlock(orderArrival - time);
+            this->inventoryLevel += orderAmount;
+            time = orderArrival;
+            orderArrival = infinity;
+        }
+        this->demandBlock(month + 1 - time);
+    }
+
+    // Compute estimates of desired measures of performance
+    result.avgHoldingCost = this->areaUnderHoldCurve * this->params.holdingCost / this->params.numberOfMonths;
+    result.avgShortageCost = this->areaUnderShortageCurve * this->params.shortageCost / this->params.numberOfMonths;
+    result.avgOrderingCost = totalOrderingCost / this->params.numberOfMonths;
+    result.avgTotalCost = result.avgHoldingCost + result.avgShortageCost + result.avgOrderingCost;
+
+    return SIMULATION_OK;
+}
+
+std::vector<PolicyResult> AggregatedDemand::simulate(void)
+{
+    std::vector<PolicyResult> results(this->params.policies.size());
+
+    for(size_t i = 0; i < results.size(); i++) {
+        this->simulatePolicy(this->params.policies[i].first, this->params.policies[i].second, results[i]);
+    }
+
+    return results;
+}
\ No newline at end of file
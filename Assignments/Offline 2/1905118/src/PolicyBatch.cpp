@@ -0,0 +1,185 @@
+#include "../include/PolicyBatch.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define POLICYBATCH_X86 1
+#endif
+
+PolicyBatch::PolicyBatch(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode)
+    : params(params), samplingMode(samplingMode), demandGen(randGen.split(1)), lagGen(randGen.split(2))
+{
+    this->demandSizes.build(this->params.demandCumulativeProbabilities);
+}
+
+void PolicyBatch::drawTrajectory(void)
+{
+    ExponentialBuffer interDemandTimes;
+    double time;
+
+    // Draw demands up to the end of the simulation; the first one past it is not needed
+    interDemandTimes.init(this->demandGen, this->params.meanInterDemandTime, this->samplingMode, 1);
+    this->demandTimes.clear();
+    this->demandAmounts.clear();
+
+    for(time = interDemandTimes.next(); time <= this->params.numberOfMonths; time += interDemandTimes.next()) {
+        this->demandTimes.push_back(time);
+        this->demandAmounts.push_back(this->demandGen.getRandomInt(this->demandSizes));
+    }
+}
+
+void PolicyBatch::evaluate(size_t first, size_t count, double time)
+{
+    // Policies below their reorder point order up to their bigs; this branches
+    // per policy, but happens once a month rather than once a demand
+    for(size_t i = first; i < first + count; i++) {
+        int smalls = this->params.policies[i].first;
+        int bigs = this->params.policies[i].second;
+
+        if(this->inventoryLevel[i] < smalls) {
+            this->orderAmount[i] = bigs - this->inventoryLevel[i];
+            this->totalOrderingCost[i] += this->params.setupCost + this->params.incrementalCost * this->orderAmount[i];
+            this->orderArrival[i] = time + this->lagStreams[i].getUniform(this->params.minArrivalLag, this->params.maxArrivalLag);
+        }
+    }
+}
+
+void PolicyBatch::simulateChunk(size_t first, size_t count)
+{
+    size_t next = 0;
+    double prev = 0.0;
+    double *level = &this->inventoryLevel[first], *arrival = &this->orderArrival[first], *amount = &this->orderAmount[first];
+    double *hold = &this->areaUnderHoldCurve[first], *shortage = &this->areaUnderShortageCurve[first];
+
+    for(int month = 0; month < this->params.numberOfMonths; month++) {
+        // Take order arrivals up to the evaluation, then evaluate
+        policyBatchStep(prev, month, 0.0, count, level, arrival, amount, hold, shortage);
+        prev = month;
+        this->evaluate(first, count, month);
+
+        // Apply the month's demands to every policy at once
+        for(; next < this->demandTimes.size() && this->demandTimes[next] <= month + 1; next++) {
+            policyBatchStep(prev, this->demandTimes[next], this->demandAmounts[next], count, level, arrival, amount, hold, shortage);
+            prev = this->demandTimes[next];
+        }
+    }
+    policyBatchStep(prev, this->params.numberOfMonths, 0.0, count, level, arrival, amount, hold, shortage);
+}
+
+std::vector<PolicyResult> PolicyBatch::simulate(void)
+{
+    size_t numberOfPolicies = this->params.policies.size();
+    std::vector<PolicyResult> results(numberOfPolicies);
+
+    this->drawTrajectory();
+
+    this->lagStreams.clear();
+    for(size_t i = 0; i < numberOfPolicies; i++) {
+        this->lagStreams.push_back(this->lagGen.substream(i, numberOfPolicies));
+    }
+    this->inventoryLevel.assign(numberOfPolicies, this->params.initialInventoryLevel);
+    this->orderArrival.assign(numberOfPolicies, std::numeric_limits<double>::infinity());
+    this->orderAmount.assign(numberOfPolicies, 0.0);
+    this->areaUnderHoldCurve.assign(numberOfPolicies, 0.0);
+    this->areaUnderShortageCurve.assign(numberOfPolicies, 0.0);
+    this->totalOrderingCost.assign(numberOfPolicies, 0.0);
+
+    // Chunks keep the state being updated in cache while the trajectory is replayed
+    for(size_t first = 0; first < numberOfPolicies; first += POLICYBATCH_CHUNK) {
+        this->simulateChunk(first, std::min<size_t>(POLICYBATCH_CHUNK, numberOfPolicies - first));
+    }
+
+    for(size_t i = 0; i < numberOfPolicies; i++) {
+        PolicyResult &result = results[i];
+
+        result.smalls = this->params.policies[i].first;
+        result.bigs = this->params.policies[i].second;
+        result.avgHoldingCost = this->areaUnderHoldCurve[i] * this->params.holdingCost / this->params.numberOfMonths;
+        result.avgShortageCost = this->areaUnderShortageCurve[i] * this->params.shortageCost / this->params.numberOfMonths;
+        result.avgOrderingCost = this->totalOrderingCost[i] / this->params.numberOfMonths;
+        result.avgTotalCost = result.avgHoldingCost + result.avgShortageCost + result.avgOrderingCost;
+    }
+
+    return results;
+}
+
+// Step kernels.  An order due by time arrives at its own arrival time, so the
+// interval is split there: the old level is integrated up to the arrival and
+// the new level after it.  The AVX2 and scalar versions do the same
+// operations in the same order, so they give identical results.
+
+static void stepScalar(double prev, double time, double amount, size_t n, double *level, double *arrival,
+                       const double *orderAmount, double *hold, double *shortage)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    for(size_t i = 0; i < n; i++) {
+        bool arrived = arrival[i] <= time;
+        double split = arrived ? arrival[i] : time;
+        double before = split - prev, after = time - split;
+
+        hold[i] += std::max(level[i], 0.0) * before;
+        shortage[i] += std::max(-level[i], 0.0) * before;
+        level[i] += arrived ? orderAmount[i] : 0.0;
+        hold[i] += std::max(level[i], 0.0) * after;
+        shortage[i] += std::max(-level[i], 0.0) * after;
+        level[i] -= amount;
+        arrival[i] = arrived ? infinity : arrival[i];
+    }
+}
+
+#ifdef POLICYBATCH_X86
+
+__attribute__((target("avx2")))
+static size_t stepAvx2(double prev, double time, double amount, size_t n, double *level, double *arrival,
+                       const double *orderAmount, double *hold, double *shortage)
+{
+    const __m256d vprev = _mm256_set1_pd(prev), vtime = _mm256_set1_pd(time), vamount = _mm256_set1_pd(amount);
+    const __m256d zero = _mm256_setzero_pd(), infinity = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256d a = _mm256_loadu_pd(arrival + i);
+        __m256d l = _mm256_loadu_pd(level + i);
+        __m256d h = _mm256_loadu_pd(hold + i);
+        __m256d s = _mm256_loadu_pd(shortage + i);
+
+        __m256d arrived = _mm256_cmp_pd(a, vtime, _CMP_LE_OQ);
+        __m256d split = _mm256_blendv_pd(vtime, a, arrived);
+        __m256d before = _mm256_sub_pd(split, vprev), after = _mm256_sub_pd(vtime, split);
+
+        h = _mm256_add_pd(h, _mm256_mul_pd(_mm256_max_pd(l, zero), before));
+        s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_max_pd(_mm256_sub_pd(zero, l), zero), before));
+        l = _mm256_add_pd(l, _mm256_and_pd(arrived, _mm256_loadu_pd(orderAmount + i)));
+        h = _mm256_add_pd(h, _mm256_mul_pd(_mm256_max_pd(l, zero), after));
+        s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_max_pd(_mm256_sub_pd(zero, l), zero), after));
+        l = _mm256_sub_pd(l, vamount);
+
+        _mm256_storeu_pd(level + i, l);
+        _mm256_storeu_pd(hold + i, h);
+        _mm256_storeu_pd(shortage + i, s);
+        _mm256_storeu_pd(arrival + i, _mm256_blendv_pd(a, infinity, arrived));
+    }
+
+    return i;
+}
+
+#endif
+
+void policyBatchStep(double prev, double time, double amount, size_t n, double *inventoryLevel, double *orderArrival,
+                     const double *orderAmount, double *areaUnderHoldCurve, double *areaUnderShortageCurve)
+{
+    size_t done = 0;
+
+#ifdef POLICYBATCH_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if(avx2) {
+        done = stepAvx2(prev, time, amount, n, inventoryLevel, orderArrival, orderAmount, areaUnderHoldCurve, areaUnderShortageCurve);
+    }
+#endif
+
+    stepScalar(prev, time, amount, n - done, inventoryLevel + done, orderArrival + done, orderAmount + done,
+               areaUnderHoldCurve + done, areaUnderShortageCurve + done);
+}
\ No newline at end of file
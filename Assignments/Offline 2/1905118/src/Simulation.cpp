@@ -1,58 +1,148 @@
 #include "../include/Simulation.h"
+#include "../include/PolicyBatch.h"
+#include "../include/AggregatedDemand.h"
 
-#include <iostream>
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 
-Simulation::Simulation() {}
+const char *statusMessage(SimulationStatus status)
+{
+    switch(status) {
+        case SIMULATION_OK:
+            return "ok";
+        case SIMULATION_INVALID_PARAMS:
+            return "invalid input parameters";
+        case SIMULATION_EVENT_LIST_EMPTY:
+            return "event list empty";
+        case SIMULATION_FILE_ERROR:
+            return "cannot open in.txt or out.txt";
+    }
+    return "unknown status";
+}
 
-void Simulation::initialize(void)
+Simulation::Simulation(SamplingMode samplingMode) : samplingMode(samplingMode), status(SIMULATION_OK) {}
+
+Simulation::Simulation(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode)
 {
-    // Initialize the simulation clock
-    this->simulationTime = 0.0;
+    this->setup(params, randGen, samplingMode);
+}
 
-    // Initialize the state variables
-    this->currentInventoryLevel = this->initialInventoryLevel;
-    this->timeOfLastEvent = 0.0;
+SimulationStatus Simulation::setup(const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode)
+{
+    this->randGen = randGen;
+    this->samplingMode = samplingMode;
+    this->status = checkParams(params);
 
-    // Initialize the statistical counters
-    this->areaUnderHoldCostCurve = 0.0;
-    this->areaUnderShortageCostCurve = 0.0;
-    this->totalOrderingCost = 0.0;
+    if(this->status == SIMULATION_OK) {
+        this->setParams(params);
+        this->prepare();
+    }
+
+    return this->status;
+}
+
+void Simulation::setParams(const InventoryParams &params)
+{
+    this->initialInventoryLevel = params.initialInventoryLevel;
+    this->numberOfMonths = params.numberOfMonths;
+    this->numberOfPolicies = (int) params.policies.size();
+    this->numberOfDemandValues = (int) params.demandCumulativeProbabilities.size();
+    this->meanInterDemandTime = params.meanInterDemandTime;
+    this->setupCost = params.setupCost;
+    this->incrementalCost = params.incrementalCost;
+    this->holdingCost = params.holdingCost;
+    this->shortageCost = params.shortageCost;
+    this->minArrivalLag = params.minArrivalLag;
+    this->maxArrivalLag = params.maxArrivalLag;
+    this->demandCumulativeProbabilities = params.demandCumulativeProbabilities;
+    this->policies = params.policies;
+}
+
+void Simulation::prepare(void)
+{
+    // build the demand size table once, so each demand costs the same however many sizes there are
+    this->demandSizes.build(this->demandCumulativeProbabilities);
 
-    // Initialize the event list
-    this->timeOfNextEvents[0] = INF;
-    this->timeOfNextEvents[1] = this->simulationTime + this->randGen.getExponential(this->meanInterDemandTime);
-    this->timeOfNextEvents[2] = this->numberOfMonths;
-    this->timeOfNextEvents[3] = 0.0;
+    // inter-demand times come from their own substream in batched mode
+    this->interDemandTimes.init(this->randGen, this->meanInterDemandTime, this->samplingMode, 1);
 }
 
-void Simulation::timing(void)
+bool Simulation::readParams(std::istream &in, InventoryParams &params)
 {
-    int i;
-    double minNextEventTime = 1.0e+29;
+    int numberOfPolicies, numberOfDemandValues;
 
-    // Determine the event type of the next event to occur
-    this->nextEventType = -1;
+    if(!(in >> params.initialInventoryLevel >> params.numberOfMonths >> numberOfPolicies >> numberOfDemandValues)) {
+        return false;
+    }
+    if(!(in >> params.meanInterDemandTime >> params.setupCost >> params.incrementalCost >> params.holdingCost >> params.shortageCost)) {
+        return false;
+    }
+    if(!(in >> params.minArrivalLag >> params.maxArrivalLag)) {
+        return false;
+    }
+    if(numberOfPolicies < 0 || numberOfDemandValues < 1) {
+        return false;
+    }
 
-    for(i = 0; i < this->numberOfEvents; i++)
-    {
-        if(this->timeOfNextEvents[i] < minNextEventTime)
-        {
-            minNextEventTime = this->timeOfNextEvents[i];
-            this->nextEventType = i;
+    params.demandCumulativeProbabilities.resize(numberOfDemandValues);
+    for(int i = 0; i < numberOfDemandValues; i++) {
+        if(!(in >> params.demandCumulativeProbabilities[i])) {
+            return false;
         }
     }
 
-    // Check to see if the event list is empty
-    if (this->nextEventType == -1)
-    {
-        // The event list is empty, so stop the simulation
-        std::cout << "\nEvent list empty at time " << this->simulationTime << '\n';
-        exit(1);
+    params.policies.resize(numberOfPolicies);
+    for(int i = 0; i < numberOfPolicies; i++) {
+        if(!(in >> params.policies[i].first >> params.policies[i].second)) {
+            return false;
+        }
     }
 
-    // The event list is not empty, so advance the simulation clock
-    this->simulationTime = minNextEventTime;
+    return checkParams(params) == SIMULATION_OK;
+}
+
+SimulationStatus Simulation::checkParams(const InventoryParams &params)
+{
+    if(params.numberOfMonths > 0 && params.meanInterDemandTime > 0.0 && params.minArrivalLag >= 0.0 &&
+       params.minArrivalLag <= params.maxArrivalLag && !params.demandCumulativeProbabilities.empty()) {
+        return SIMULATION_OK;
+    }
+    return SIMULATION_INVALID_PARAMS;
+}
+
+double Simulation::expectedDraws(const InventoryParams &params, SamplingMode samplingMode)
+{
+    // Each policy draws an inter-demand time and a size per demand, and at most one lag a month
+    double numberOfPolicies = std::max<size_t>(params.policies.size(), 1);
+    double demands = params.numberOfMonths / params.meanInterDemandTime;
+
+    // Batched mode draws the inter-demand times from their own stream, a block ahead
+    if(samplingMode == SAMPLING_BATCHED) {
+        return std::max(numberOfPolicies * (demands + params.numberOfMonths), numberOfPolicies * demands + RANDGEN_BLOCK);
+    }
+    return numberOfPolicies * (2.0 * demands + params.numberOfMonths);
+}
+
+void Simulation::initialize(void)
+{
+    // Initialize the simulation clock and empty the event list
+    this->resetKernel();
+
+    // Initialize the state variables
+    this->currentInventoryLevel = this->initialInventoryLevel;
+    this->ended = false;
+
+    // Initialize the statistical counters
+    this->areaUnderHoldCostCurve = 0.0;
+    this->areaUnderShortageCostCurve = 0.0;
+    this->totalOrderingCost = 0.0;
+
+    // Initialize the event list; no order is outstanding
+    this->orderArrivalEvent = -1;
+    this->eventList.schedule(this->simulationTime + this->interDemandTimes.next(), 1);
+    this->eventList.schedule(this->numberOfMonths, 2);
+    this->eventList.schedule(0.0, 3);
 }
 
 void Simulation::orderArrival(void)
@@ -60,17 +150,17 @@ void Simulation::orderArrival(void)
     // Increment the inventory level by the order amount
     this->currentInventoryLevel += this->orderAmount;
 
-    // Since no order is outstanding, eliminate the order arrival event from consideration
-    this->timeOfNextEvents[0] = INF;
+    // The order arrival event has been removed from the event list, so no order is outstanding
+    this->orderArrivalEvent = -1;
 }
 
 void Simulation::demand(void)
 {
     // Decrement the inventory level by the demand amount
-    this->currentInventoryLevel -= this->randGen.getRandomInt(this->demandCumulativeProbabilities);
+    this->currentInventoryLevel -= this->randGen.getRandomInt(this->demandSizes);
 
     // Schedule the next demand event
-    this->timeOfNextEvents[1] = this->simulationTime + this->randGen.getExponential(this->meanInterDemandTime);
+    this->eventList.schedule(this->simulationTime + this->interDemandTimes.next(), 1);
 }
 
 void Simulation::evaluate(void)
@@ -81,33 +171,31 @@ void Simulation::evaluate(void)
         this->orderAmount = this->bigs - this->currentInventoryLevel;
         this->totalOrderingCost += this->setupCost + this->incrementalCost * this->orderAmount;
 
-        // Schedule the order arrival event
-        this->timeOfNextEvents[0] = this->simulationTime + this->randGen.getUniform(this->minArrivalLag, this->maxArrivalLag);
+        // Schedule the order arrival event, replacing any order still outstanding
+        double arrivalTime = this->simulationTime + this->randGen.getUniform(this->minArrivalLag, this->maxArrivalLag);
+        if(this->eventList.isPending(this->orderArrivalEvent)) {
+            this->eventList.reschedule(this->orderArrivalEvent, arrivalTime);
+        } else {
+            this->orderArrivalEvent = this->eventList.schedule(arrivalTime, 0);
+        }
     }
 
     // Regardless of whether an order is placed, schedule the next evaluation event
-    this->timeOfNextEvents[3] = this->simulationTime + 1.0;
+    this->eventList.schedule(this->simulationTime + 1.0, 3);
 }
 
-void Simulation::report(void)
+void Simulation::report(const PolicyResult &result)
 {
-    // Compute and write estimates of desired measures of performance
-    double avgHoldCost = this->areaUnderHoldCostCurve * this->holdingCost / this->numberOfMonths;
-    double avgShortageCost = this->areaUnderShortageCostCurve * this->shortageCost / this->numberOfMonths;
-    double avgOrderingCost = this->totalOrderingCost / this->numberOfMonths;
-
-    this->outFile << '(' << std::setw(2) << this->smalls << "," << std::setw(3) << this->bigs << ')';
-    this->outFile << std::setw(20) << avgHoldCost + avgShortageCost + avgOrderingCost;
-    this->outFile << std::setw(20) << avgOrderingCost;
-    this->outFile << std::setw(20) << avgHoldCost;
-    this->outFile << std::setw(20) << avgShortageCost << "\n\n";    
+    // Write estimates of desired measures of performance
+    this->outFile << '(' << std::setw(2) << result.smalls << "," << std::setw(3) << result.bigs << ')';
+    this->outFile << std::setw(20) << result.avgTotalCost;
+    this->outFile << std::setw(20) << result.avgOrderingCost;
+    this->outFile << std::setw(20) << result.avgHoldingCost;
+    this->outFile << std::setw(20) << result.avgShortageCost << "\n\n";
 }
 
-void Simulation::updateTimeAvgStats(void)
+void Simulation::updateTimeAvgStats(double timeSinceLastEvent)
 {
-    double timeSinceLastEvent = this->simulationTime - this->timeOfLastEvent;
-    this->timeOfLastEvent = this->simulationTime;
-
     if(this->currentInventoryLevel < 0) {
         this->areaUnderShortageCostCurve -= this->currentInventoryLevel * timeSinceLastEvent;
     } else {
@@ -115,40 +203,102 @@ void Simulation::updateTimeAvgStats(void)
     }
 }
 
-void Simulation::run()
+SimulationStatus Simulation::simulatePolicy(int smalls, int bigs, PolicyResult &result)
 {
-    // open input and output files
-    this->inFile.open("in.txt");
-    this->outFile.open("out.txt");
+    result.smalls = smalls;
+    result.bigs = bigs;
+    result.avgTotalCost = result.avgOrderingCost = result.avgHoldingCost = result.avgShortageCost = std::numeric_limits<double>::quiet_NaN();
+    if(this->status != SIMULATION_OK) {
+        return this->status;
+    }
+
+    this->smalls = smalls;
+    this->bigs = bigs;
+
+    this->initialize();
 
-    // check if the files are opened successfully
-    if(!this->inFile.is_open() || !this->outFile.is_open()) {
-        std::cout << "Error opening files\n";
-        exit(1);
+    // Run the simulation until the end of simulation event
+    if(this->runEvents() != KERNEL_DONE) {
+        return SIMULATION_EVENT_LIST_EMPTY;
     }
 
-    // read the input parameters
-    this->inFile >> this->initialInventoryLevel;
-    this->inFile >> this->numberOfMonths;
-    this->inFile >> this->numberOfPolicies;
-    this->inFile >> this->numberOfDemandValues;
+    // Compute estimates of desired measures of performance
+    result.avgHoldingCost = this->areaUnderHoldCostCurve * this->holdingCost / this->numberOfMonths;
+    result.avgShortageCost = this->areaUnderShortageCostCurve * this->shortageCost / this->numberOfMonths;
+    result.avgOrderingCost = this->totalOrderingCost / this->numberOfMonths;
+    result.avgTotalCost = result.avgHoldingCost + result.avgShortageCost + result.avgOrderingCost;
 
-    this->demandCumulativeProbabilities.resize(this->numberOfDemandValues);
+    return SIMULATION_OK;
+}
 
-    this->numberOfEvents = 4;
-    this->timeOfNextEvents.resize(this->numberOfEvents);
+SimulationStatus Simulation::simulate(std::vector<PolicyResult> &results)
+{
+    SimulationStatus status = this->status;
+
+    // Policies run one after another on the same random number stream, as in run()
+    results.resize(this->policies.size());
+    for(size_t i = 0; i < this->policies.size(); i++) {
+        SimulationStatus policyStatus = this->simulatePolicy(this->policies[i].first, this->policies[i].second, results[i]);
+        if(status == SIMULATION_OK) {
+            status = policyStatus;
+        }
+    }
 
-    this->inFile >> this->meanInterDemandTime;
-    this->inFile >> this->setupCost;
-    this->inFile >> this->incrementalCost;
-    this->inFile >> this->holdingCost;
-    this->inFile >> this->shortageCost;
-    this->inFile >> this->minArrivalLag;
-    this->inFile >> this->maxArrivalLag;
+    return status;
+}
 
-    for(int i = 0; i < this->numberOfDemandValues; i++) {
-        this->inFile >> this->demandCumulativeProbabilities[i];
+SimulationStatus Simulation::simulatePolicies(ThreadPool &pool, const InventoryParams &params, const RandGen &randGen, SamplingMode samplingMode,
+                                              std::vector<PolicyResult> &results)
+{
+    size_t numberOfPolicies = params.policies.size();
+    std::vector<SimulationStatus> statuses(numberOfPolicies);
+
+    // The per-policy simulations only need the model, not the whole policy list
+    InventoryParams model = params;
+    model.policies.clear();
+
+    results.resize(numberOfPolicies);
+    pool.parallelFor(numberOfPolicies, [&](size_t i) {
+        Simulation simulation(model, randGen.substream(i, numberOfPolicies), samplingMode);
+
+        statuses[i] = simulation.simulatePolicy(params.policies[i].first, params.policies[i].second, results[i]);
+    });
+
+    // Report the first policy that failed, if any
+    for(SimulationStatus status : statuses) {
+        if(status != SIMULATION_OK) {
+            return status;
+        }
+    }
+    return checkParams(params);
+}
+
+SimulationStatus Simulation::run(PolicyEvaluation evaluation, unsigned numberOfThreads)
+{
+    InventoryParams params;
+    std::vector<PolicyResult> results;
+    SimulationStatus status = SIMULATION_OK;
+
+    // open the input file
+    this->inFile.open("in.txt");
+
+    if(!this->inFile.is_open()) {
+        return SIMULATION_FILE_ERROR;
+    }
+
+    // read the input parameters, and reject them before out.txt is truncated
+    if(!readParams(this->inFile, params)) {
+        return SIMULATION_INVALID_PARAMS;
+    }
+
+    // open the output file
+    this->outFile.open("out.txt");
+
+    if(!this->outFile.is_open()) {
+        return SIMULATION_FILE_ERROR;
     }
+    this->setParams(params);
+    this->prepare();
 
     this->outFile << std::fixed << std::setprecision(2);
 
@@ -177,31 +327,24 @@ void Simulation::run()
     this->outFile << " Policy        Avg_total_cost     Avg_ordering_cost      Avg_holding_cost     Avg_shortage_cost\n";
     this->outFile << "--------------------------------------------------------------------------------------------------\n\n";
 
-    for(int i = 0; i < this->numberOfPolicies; i++) {
-        this->inFile >> this->smalls >> this->bigs;
+    if(evaluation == EVALUATE_PARALLEL) {
+        ThreadPool pool(numberOfThreads);
 
-        this->initialize();
+        status = simulatePolicies(pool, params, this->randGen, this->samplingMode, results);
+    } else if(evaluation == EVALUATE_LOCKSTEP) {
+        PolicyBatch batch(params, this->randGen, this->samplingMode);
 
-        do {
-            this->timing();
+        results = batch.simulate();
+    } else if(evaluation == EVALUATE_AGGREGATED) {
+        AggregatedDemand aggregated(params, this->randGen);
 
-            this->updateTimeAvgStats();
+        results = aggregated.simulate();
+    } else {
+        status = this->simulate(results);
+    }
 
-            switch(this->nextEventType) {
-                case 0:
-                    this->orderArrival();
-                    break;
-                case 1:
-                    this->demand();
-                    break;
-                case 3:
-                    this->evaluate();
-                    break;
-                case 2:
-                    this->report();
-                    break;
-            }
-        } while(this->nextEventType != 2);
+    for(const PolicyResult &result : results) {
+        this->report(result);
     }
 
         this->outFile << "--------------------------------------------------------------------------------------------------";
@@ -210,4 +353,5 @@ void Simulation::run()
     this->inFile.close();
     this->outFile.close();
 
+    return status;
 }
\ No newline at end of file
@@ -1,9 +1,315 @@
 #include "../include/Simulation.h"
+#include "Replication.h"
+#include "Sequential.h"
+#include "../include/Selection.h"
+#include "Statistics.h"
 
-int main()
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Refuse to run numberOfReplications replications whose streams would take
+// more than their share of the generator and overlap
+static void checkBudget(double draws, size_t numberOfReplications, SamplingMode mode)
+{
+    double budget = replicationBudget(RandGen(), numberOfReplications, mode);
+
+    if(draws > budget) {
+        std::cout << "Error: a replication needs about " << draws << " random numbers per stream, but each of ";
+        std::cout << numberOfReplications << " substreams holds " << budget;
+        std::cout << "; run fewer replications or build with -DRANDGEN_GENERATOR=Pcg64\n";
+        exit(1);
+    }
+}
+
+// Run independent replications of every policy in in.txt on a thread pool and
+// write each replication's total costs, then 95% confidence intervals for every
+// cost of every policy, to replications.txt
+void replicate(int numberOfReplications, unsigned numberOfThreads, SamplingMode mode)
+{
+    InventoryParams params;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("replications.txt");
+
+    if(!inFile.is_open() || !outFile.is_open()) {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if(!Simulation::readParams(inFile, params)) {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    checkBudget(Simulation::expectedDraws(params, mode), numberOfReplications, mode);
+
+    // Replication r runs on substream r, so the results do not depend on the number of threads
+    ThreadPool pool(numberOfThreads);
+    std::vector<std::vector<PolicyResult>> results = runReplications<std::vector<PolicyResult>>(pool, numberOfReplications, RandGen(), [&](const RandGen &randGen) {
+        std::vector<PolicyResult> results;
+        Simulation simulation(params, randGen, mode);
+        simulation.simulate(results);
+        return results;
+    });
+
+    size_t numberOfPolicies = params.policies.size();
+    std::vector<RunningStat> totalCost(numberOfPolicies), orderingCost(numberOfPolicies), holdingCost(numberOfPolicies), shortageCost(numberOfPolicies);
+
+    outFile << std::fixed << std::setprecision(2);
+
+    outFile << "Average total cost of each replication\n\n";
+    outFile << std::left << std::setw(12) << "Replication" << std::right;
+    for(const std::pair<int, int> &policy : params.policies) {
+        outFile << std::setw(5) << '(' << std::setw(2) << policy.first << "," << std::setw(3) << policy.second << ')';
+    }
+    outFile << "\n";
+
+    for(int r = 0; r < numberOfReplications; r++) {
+        outFile << std::left << std::setw(12) << r + 1 << std::right;
+        for(size_t i = 0; i < numberOfPolicies; i++) {
+            const PolicyResult &result = results[r][i];
+
+            outFile << std::setw(12) << result.avgTotalCost;
+            totalCost[i].add(result.avgTotalCost);
+            orderingCost[i].add(result.avgOrderingCost);
+            holdingCost[i].add(result.avgHoldingCost);
+            shortageCost[i].add(result.avgShortageCost);
+        }
+        outFile << "\n";
+    }
+
+    outFile << "\nMean, variance and 95% confidence interval half-length over " << numberOfReplications << " replications\n\n";
+    outFile << " Policy                  Avg_total_cost       Avg_ordering_cost        Avg_holding_cost       Avg_shortage_cost\n";
+    for(size_t i = 0; i < numberOfPolicies; i++) {
+        const RunningStat *stats[] = {&totalCost[i], &orderingCost[i], &holdingCost[i], &shortageCost[i]};
+        const char *labels[] = {"mean", "variance", "+/-"};
+
+        for(int row = 0; row < 3; row++) {
+            if(row == 0) {
+                outFile << '(' << std::setw(2) << params.policies[i].first << "," << std::setw(3) << params.policies[i].second << ')';
+            } else {
+                outFile << std::setw(8) << "";
+            }
+            outFile << std::setw(10) << labels[row];
+
+            for(const RunningStat *stat : stats) {
+                ConfidenceInterval ci = confidenceInterval(*stat, 0.95);
+                outFile << std::setw(24) << (row == 0 ? ci.mean : row == 1 ? stat->variance() : ci.halfLength);
+            }
+            outFile << "\n";
+        }
+        outFile << "\n";
+    }
+}
+
+// Add replications of every policy in in.txt until the confidence interval for
+// each policy's average total cost meets rule, and write the intervals to sequential.txt
+void sequential(const StoppingRule &rule, SamplingMode mode)
 {
-    Simulation simulation;
-    simulation.run();
+    InventoryParams params;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("sequential.txt");
+
+    if(!inFile.is_open() || !outFile.is_open()) {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if(!Simulation::readParams(inFile, params)) {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    checkBudget(Simulation::expectedDraws(params, mode), rule.maxRuns, mode);
+
+    ThreadPool pool;
+    SequentialRun<std::vector<PolicyResult>> run = runSequential<std::vector<PolicyResult>>(pool, rule, RandGen(), [&](const RandGen &randGen) {
+        std::vector<PolicyResult> results;
+        Simulation simulation(params, randGen, mode);
+        simulation.simulate(results);
+        return results;
+    }, [](const std::vector<PolicyResult> &results) {
+        std::vector<double> totalCosts;
+        for(const PolicyResult &result : results) {
+            totalCosts.push_back(result.avgTotalCost);
+        }
+        return totalCosts;
+    });
+
+    outFile << (rule.target == PRECISION_ABSOLUTE ? "Absolute error beta: " : "Relative error gamma: ") << rule.precision;
+    outFile << ", confidence: " << rule.confidence << "\n\n";
+    outFile << (run.converged ? "Target met" : "Target not met") << " for every policy after " << run.results.size() << " replications\n\n";
+
+    outFile << std::fixed << std::setprecision(4);
+    outFile << " Policy              Mean         Std_dev        Variance     Half-length       Half/mean\n";
+    for(size_t i = 0; i < run.stats.size(); i++) {
+        ConfidenceInterval ci = confidenceInterval(run.stats[i], rule.confidence);
+
+        outFile << '(' << std::setw(2) << params.policies[i].first << "," << std::setw(3) << params.policies[i].second << ')';
+        outFile << std::setw(16) << ci.mean;
+        outFile << std::setw(16) << std::sqrt(run.stats[i].variance());
+        outFile << std::setw(16) << run.stats[i].variance();
+        outFile << std::setw(16) << ci.halfLength;
+        outFile << std::setw(16) << ci.halfLength / std::fabs(ci.mean) << "\n";
+    }
+}
+
+// Select the policy in in.txt with the least average total cost by the
+// Kim-Nelson procedure, dropping clearly worse policies as replications come
+// in, and write the outcome to selection.txt
+void select(const SelectionRule &rule, unsigned numberOfThreads, SamplingMode mode)
+{
+    InventoryParams params;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("selection.txt");
+
+    if(!inFile.is_open() || !outFile.is_open()) {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if(!Simulation::readParams(inFile, params)) {
+        std::cout << "Error: invalid input parameters\n";
+        exit(1);
+    }
+
+    if(params.policies.empty()) {
+        std::cout << "Error: no policies to select from\n";
+        exit(1);
+    }
+
+    // Each replication simulates a single policy
+    InventoryParams model = params;
+    model.policies.clear();
+    checkBudget(Simulation::expectedDraws(model, mode), rule.maxRuns, mode);
+
+    ThreadPool pool(numberOfThreads);
+    SelectionRun run = runKimNelson(pool, rule, params.policies.size(), RandGen(), [&](size_t i, const RandGen &randGen) {
+        PolicyResult result;
+        Simulation simulation(model, randGen, mode);
+        simulation.simulatePolicy(params.policies[i].first, params.policies[i].second, result);
+        return result.avgTotalCost;
+    });
+
+    long replications = 0;
+    for(const RunningStat &stat : run.stats) {
+        replications += stat.count();
+    }
+
+    outFile << "Indifference zone delta: " << rule.indifference << ", confidence: " << rule.confidence;
+    outFile << ", first stage: " << rule.firstStage << " replications\n\n";
+
+    outFile << std::fixed << std::setprecision(4);
+    outFile << " Policy    Replications            Mean         Std_dev   Outcome\n";
+    for(size_t i = 0; i < run.stats.size(); i++) {
+        outFile << '(' << std::setw(2) << params.policies[i].first << "," << std::setw(3) << params.policies[i].second << ')';
+        outFile << std::setw(16) << run.stats[i].count();
+        outFile << std::setw(16) << run.stats[i].mean();
+        outFile << std::setw(16) << std::sqrt(run.stats[i].variance()) << "   ";
+        if(i == run.best) {
+            outFile << "selected\n";
+        } else if(run.dropped[i] > 0) {
+            outFile << "dropped at stage " << run.dropped[i] << "\n";
+        } else {
+            outFile << "in contention\n";
+        }
+    }
+
+    const std::pair<int, int> &best = params.policies[run.best];
+    outFile << std::defaultfloat;
+    outFile << "\nBest policy: (" << best.first << "," << best.second << ")";
+    if(run.resolved) {
+        outFile << ", correct with probability at least " << rule.confidence << " if its mean cost is " << rule.indifference << " below every other\n";
+    } else {
+        outFile << ", least mean after " << run.stages << " stages; the others were not screened out\n";
+    }
+    outFile << "Replications: " << replications << ", against " << run.stages * run.stats.size() << " for the same " << run.stages << " stages of every policy\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // "batched" draws variates in blocks instead of reproducing the reference output
+    SamplingMode mode = SAMPLING_REFERENCE;
+    if(argc > 1 && std::string(argv[argc - 1]) == "batched") {
+        mode = SAMPLING_BATCHED;
+    }
+
+    // "replicate N [threads]" runs N independent replications instead of a single run
+    if(argc > 2 && std::string(argv[1]) == "replicate") {
+        int numberOfReplications = atoi(argv[2]);
+        unsigned numberOfThreads = (argc > 3 && std::string(argv[3]) != "batched") ? (unsigned) atoi(argv[3]) : 0;
+
+        if(numberOfReplications < 2) {
+            std::cout << "Error: at least 2 replications are needed\n";
+            exit(1);
+        }
+
+        replicate(numberOfReplications, numberOfThreads, mode);
+        return 0;
+    }
+
+    // "sequential abs|rel <precision> [confidence]" runs until every policy's cost is that precise
+    if(argc > 3 && std::string(argv[1]) == "sequential") {
+        StoppingRule rule;
+
+        rule.target = std::string(argv[2]) == "rel" ? PRECISION_RELATIVE : PRECISION_ABSOLUTE;
+        rule.precision = atof(argv[3]);
+        rule.confidence = (argc > 4 && std::string(argv[4]) != "batched") ? atof(argv[4]) : 0.95;
+        rule.minRuns = 10;
+        rule.maxRuns = 10000;
+
+        if(rule.precision <= 0.0 || rule.confidence <= 0.0 || rule.confidence >= 1.0) {
+            std::cout << "Error: invalid precision or confidence\n";
+            exit(1);
+        }
+
+        sequential(rule, mode);
+        return 0;
+    }
+
+    // "select <delta> [confidence] [threads]" picks the best policy, screening out the others as it goes
+    if(argc > 2 && std::string(argv[1]) == "select") {
+        SelectionRule rule;
+        unsigned numberOfThreads = (argc > 4 && std::string(argv[4]) != "batched") ? (unsigned) atoi(argv[4]) : 0;
+
+        rule.indifference = atof(argv[2]);
+        rule.confidence = (argc > 3 && std::string(argv[3]) != "batched") ? atof(argv[3]) : 0.95;
+        rule.firstStage = 10;
+        rule.maxRuns = 10000;
+
+        if(rule.indifference <= 0.0 || rule.confidence <= 0.0 || rule.confidence >= 1.0) {
+            std::cout << "Error: invalid indifference zone or confidence\n";
+            exit(1);
+        }
+
+        select(rule, numberOfThreads, mode);
+        return 0;
+    }
+
+    // "parallel [threads]" evaluates the policies concurrently, each on its own stream;
+    // "lockstep" evaluates them together on one shared demand trajectory;
+    // "aggregated" draws each interval's demands as one block instead of event by event
+    PolicyEvaluation evaluation = EVALUATE_SERIAL;
+    unsigned numberOfThreads = 0;
+    if(argc > 1 && std::string(argv[1]) == "parallel") {
+        evaluation = EVALUATE_PARALLEL;
+        if(argc > 2 && std::string(argv[2]) != "batched") {
+            numberOfThreads = (unsigned) atoi(argv[2]);
+        }
+    } else if(argc > 1 && std::string(argv[1]) == "lockstep") {
+        evaluation = EVALUATE_LOCKSTEP;
+    } else if(argc > 1 && std::string(argv[1]) == "aggregated") {
+        evaluation = EVALUATE_AGGREGATED;
+    }
+
+    Simulation simulation(mode);
+    SimulationStatus status = simulation.run(evaluation, numberOfThreads);
+    if(status != SIMULATION_OK) {
+        std::cout << "Error: " << statusMessage(status) << "\n";
+        exit(1);
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "RandGen.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+enum DurationDistribution {
+    DURATION_TRIANGULAR,                               // Triangular(a, b, m) by inverse transform
+    DURATION_RIGHT_TRIANGULAR,                         // RT(a, b): a + (b - a) max(U1, U2)
+    DURATION_LEFT_TRIANGULAR                           // LT(a, b): a + (b - a) min(U1, U2)
+};
+
+struct Task {
+    std::string name;                                  // Name of the task
+    std::vector<std::string> predecessors;             // Tasks that must finish before this one starts
+    double lower;                                      // a, the shortest duration
+    double mode;                                       // m, the most likely duration
+    double upper;                                      // b, the longest duration
+};
+
+// Task network in topological order.  Everything a trial touches is kept in
+// flat arrays indexed by position in that order, and predecessor lists are
+// stored back to back (compressed rows), so a pass over the network is one
+// forward sweep through memory.  Trials are processed a block at a time with
+// one row of n values per task, and the per-trial work is vectorised across
+// the row.
+class ProjectNetwork {
+public:
+    // Sort tasks topologically; on failure (unknown predecessor, cycle, ...) error says why
+    bool build(const std::vector<Task> &tasks, std::string &error);
+
+    size_t size() const { return this->order.size(); }
+    int taskAt(size_t k) const { return this->order[k]; }
+    double lower(size_t k) const { return this->lowers[k]; }
+    double mode(size_t k) const { return this->modes[k]; }
+    double upper(size_t k) const { return this->uppers[k]; }
+
+    // Early start and finish times of n trials, and the project duration (the
+    // latest finish) of each.  durations, start and finish hold one row of n
+    // values per task, in topological order.
+    void schedule(const double *durations, double *start, double *finish, double *projectDuration, size_t n) const;
+
+    // Set critical row k to 1 in the trials where task k lies on a longest
+    // path and to 0 elsewhere; ties make every tied path critical
+    void markCritical(const double *start, const double *finish, const double *projectDuration, double *critical, size_t n) const;
+
+private:
+    std::vector<int> order;                            // Task index of each position
+    std::vector<int> predecessorStart;                 // Predecessors of position k are at [predecessorStart[k], predecessorStart[k + 1])
+    std::vector<int> predecessorList;                  // Positions of the predecessors
+    std::vector<double> lowers;                        // a of each position
+    std::vector<double> modes;                         // m of each position
+    std::vector<double> uppers;                        // b of each position
+};
+
+struct ProjectModel {
+    std::string name;                                  // Name of the project
+    double deadline;                                   // Deadline for the success rate
+    std::vector<Task> tasks;                           // Tasks in input order
+    ProjectNetwork network;                            // Tasks in topological order
+};
+
+struct ProjectResult {
+    RunningStat duration;                              // Project duration
+    RunningStat success;                               // Indicator that the project meets the deadline
+    std::vector<RunningStat> criticality;              // Indicator that each task (input order) is critical
+};
+
+// Estimate the project duration distribution from trials independent trials
+// on pool.  As in the other Monte Carlo engines the trials are cut into a
+// fixed number of pieces with their own substreams of randGen, so the result
+// does not depend on the number of threads.  Trials draw from TrialRandGen,
+// since a trial takes about two uniforms per task.
+ProjectResult simulateProject(ThreadPool &pool, const ProjectModel &model, DurationDistribution distribution, long trials,
+                              const TrialRandGen &randGen);
+
+#endif // PROJECT_H
\ No newline at end of file
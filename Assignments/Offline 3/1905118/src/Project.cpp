@@ -0,0 +1,299 @@
+#include "../include/Project.h"
+
+#include <algorithm>
+#include <map>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define PROJECT_X86 1
+#endif
+
+#define PROJECT_PIECES 256                             // Most pieces a run is cut into
+
+bool ProjectNetwork::build(const std::vector<Task> &tasks, std::string &error) {
+    std::map<std::string, int> index;
+    std::vector<std::vector<int>> successors(tasks.size());
+    std::vector<int> waiting(tasks.size(), 0), position(tasks.size());
+
+    for(size_t t = 0; t < tasks.size(); t++) {
+        if(!index.insert(std::make_pair(tasks[t].name, (int) t)).second) {
+            error = "task " + tasks[t].name + " is given twice";
+            return false;
+        }
+        if(!(tasks[t].lower <= tasks[t].mode && tasks[t].mode <= tasks[t].upper)) {
+            error = "task " + tasks[t].name + " needs a <= m <= b";
+            return false;
+        }
+    }
+
+    for(size_t t = 0; t < tasks.size(); t++) {
+        for(const std::string &name : tasks[t].predecessors) {
+            std::map<std::string, int>::const_iterator it = index.find(name);
+            if(it == index.end()) {
+                error = "unknown predecessor " + name + " of task " + tasks[t].name;
+                return false;
+            }
+            successors[it->second].push_back((int) t);
+            waiting[t]++;
+        }
+    }
+
+    // Kahn's algorithm; tasks that become ready together keep their input order
+    this->order.clear();
+    for(size_t t = 0; t < tasks.size(); t++) {
+        if(waiting[t] == 0) {
+            this->order.push_back((int) t);
+        }
+    }
+    for(size_t k = 0; k < this->order.size(); k++) {
+        for(int s : successors[this->order[k]]) {
+            if(--waiting[s] == 0) {
+                this->order.push_back(s);
+            }
+        }
+    }
+    if(this->order.size() != tasks.size()) {
+        error = "the precedence relations contain a cycle";
+        return false;
+    }
+
+    this->predecessorStart.assign(1, 0);
+    this->predecessorList.clear();
+    this->lowers.clear();
+    this->modes.clear();
+    this->uppers.clear();
+    for(size_t k = 0; k < this->order.size(); k++) {
+        position[this->order[k]] = (int) k;
+    }
+    for(size_t k = 0; k < this->order.size(); k++) {
+        const Task &task = tasks[this->order[k]];
+
+        for(const std::string &name : task.predecessors) {
+            this->predecessorList.push_back(position[index[name]]);
+        }
+        this->predecessorStart.push_back((int) this->predecessorList.size());
+        this->lowers.push_back(task.lower);
+        this->modes.push_back(task.mode);
+        this->uppers.push_back(task.upper);
+    }
+
+    return true;
+}
+
+// Row kernels over n trials, each with an AVX2 body and a scalar remainder
+
+#ifdef PROJECT_X86
+
+static bool useAvx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+__attribute__((target("avx2")))
+static size_t maxIntoAvx2(double *dest, const double *src, size_t n) {
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dest + i, _mm256_max_pd(_mm256_loadu_pd(dest + i), _mm256_loadu_pd(src + i)));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t addAvx2(double *dest, const double *a, const double *b, size_t n) {
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dest + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t flagEqualAvx2(double *dest, const double *a, const double *b, size_t n) {
+    __m256d one = _mm256_set1_pd(1.0);
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256d equal = _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_EQ_OQ);
+        _mm256_storeu_pd(dest + i, _mm256_and_pd(equal, one));
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t propagateAvx2(double *critical, const double *successorCritical, const double *finish, const double *successorStart, size_t n) {
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256d binding = _mm256_cmp_pd(_mm256_loadu_pd(finish + i), _mm256_loadu_pd(successorStart + i), _CMP_EQ_OQ);
+        __m256d inherited = _mm256_and_pd(binding, _mm256_loadu_pd(successorCritical + i));
+        _mm256_storeu_pd(critical + i, _mm256_or_pd(_mm256_loadu_pd(critical + i), inherited));
+    }
+
+    return i;
+}
+
+#endif
+
+// dest = max(dest, src)
+static void maxInto(double *dest, const double *src, size_t n) {
+    size_t i = 0;
+
+#ifdef PROJECT_X86
+    if(useAvx2()) {
+        i = maxIntoAvx2(dest, src, n);
+    }
+#endif
+
+    for(; i < n; i++) {
+        dest[i] = std::max(dest[i], src[i]);
+    }
+}
+
+// dest = a + b
+static void add(double *dest, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+
+#ifdef PROJECT_X86
+    if(useAvx2()) {
+        i = addAvx2(dest, a, b, n);
+    }
+#endif
+
+    for(; i < n; i++) {
+        dest[i] = a[i] + b[i];
+    }
+}
+
+// dest = 1 where a == b, else 0
+static void flagEqual(double *dest, const double *a, const double *b, size_t n) {
+    size_t i = 0;
+
+#ifdef PROJECT_X86
+    if(useAvx2()) {
+        i = flagEqualAvx2(dest, a, b, n);
+    }
+#endif
+
+    for(; i < n; i++) {
+        dest[i] = a[i] == b[i] ? 1.0 : 0.0;
+    }
+}
+
+// A predecessor is critical where a critical successor starts the moment it finishes
+static void propagate(double *critical, const double *successorCritical, const double *finish, const double *successorStart, size_t n) {
+    size_t i = 0;
+
+#ifdef PROJECT_X86
+    if(useAvx2()) {
+        i = propagateAvx2(critical, successorCritical, finish, successorStart, n);
+    }
+#endif
+
+    for(; i < n; i++) {
+        if(successorCritical[i] != 0.0 && finish[i] == successorStart[i]) {
+            critical[i] = 1.0;
+        }
+    }
+}
+
+void ProjectNetwork::schedule(const double *durations, double *start, double *finish, double *projectDuration, size_t n) const {
+    for(size_t k = 0; k < this->order.size(); k++) {
+        double *row = start + k * n;
+        int first = this->predecessorStart[k], last = this->predecessorStart[k + 1];
+
+        if(first == last) {
+            std::fill(row, row + n, 0.0);
+        } else {
+            std::copy(finish + this->predecessorList[first] * n, finish + (this->predecessorList[first] + 1) * n, row);
+            for(int j = first + 1; j < last; j++) {
+                maxInto(row, finish + this->predecessorList[j] * n, n);
+            }
+        }
+        add(finish + k * n, row, durations + k * n, n);
+    }
+
+    std::copy(finish, finish + n, projectDuration);
+    for(size_t k = 1; k < this->order.size(); k++) {
+        maxInto(projectDuration, finish + k * n, n);
+    }
+}
+
+void ProjectNetwork::markCritical(const double *start, const double *finish, const double *projectDuration, double *critical, size_t n) const {
+    // A task that ends with the project is critical, and so is every task that
+    // holds up a critical task; successors come later, so one backward sweep will do
+    for(size_t k = 0; k < this->order.size(); k++) {
+        flagEqual(critical + k * n, finish + k * n, projectDuration, n);
+    }
+    for(size_t k = this->order.size(); k-- > 0;) {
+        for(int j = this->predecessorStart[k]; j < this->predecessorStart[k + 1]; j++) {
+            int p = this->predecessorList[j];
+            propagate(critical + p * n, critical + k * n, finish + p * n, start + k * n, n);
+        }
+    }
+}
+
+// Durations of one task for n trials, as in the workbook sheets
+static void sampleDurations(TrialRandGen &randGen, DurationDistribution distribution, double a, double m, double b, double *out, size_t n) {
+    if(distribution == DURATION_TRIANGULAR) {
+        randGen.getTriangularBlock(a, m, b, out, n);
+    } else if(distribution == DURATION_RIGHT_TRIANGULAR) {
+        randGen.getRightTriangularBlock(a, b, out, n);
+    } else {
+        randGen.getLeftTriangularBlock(a, b, out, n);
+    }
+}
+
+ProjectResult simulateProject(ThreadPool &pool, const ProjectModel &model, DurationDistribution distribution, long trials,
+                              const TrialRandGen &randGen) {
+    const ProjectNetwork &network = model.network;
+    size_t numberOfTasks = network.size();
+    long pieces = std::min<long>(PROJECT_PIECES, (trials + RANDGEN_BLOCK - 1) / RANDGEN_BLOCK);
+    std::vector<ProjectResult> results(pieces);
+
+    pool.parallelFor(pieces, [&](size_t p) {
+        ProjectResult &result = results[p];
+        TrialRandGen generator = randGen.substream(p, pieces);
+        std::vector<double> durations(numberOfTasks * RANDGEN_BLOCK), start(numberOfTasks * RANDGEN_BLOCK);
+        std::vector<double> finish(numberOfTasks * RANDGEN_BLOCK), critical(numberOfTasks * RANDGEN_BLOCK);
+        double projectDuration[RANDGEN_BLOCK], success[RANDGEN_BLOCK];
+        long first = trials * (long) p / pieces, last = trials * (long) (p + 1) / pieces;
+
+        result.criticality.resize(numberOfTasks);
+        for(long done = first; done < last; done += RANDGEN_BLOCK) {
+            size_t n = (size_t) std::min<long>(RANDGEN_BLOCK, last - done);
+
+            for(size_t k = 0; k < numberOfTasks; k++) {
+                sampleDurations(generator, distribution, network.lower(k), network.mode(k), network.upper(k), &durations[k * n], n);
+            }
+            network.schedule(durations.data(), start.data(), finish.data(), projectDuration, n);
+            network.markCritical(start.data(), finish.data(), projectDuration, critical.data(), n);
+
+            for(size_t i = 0; i < n; i++) {
+                success[i] = projectDuration[i] <= model.deadline ? 1.0 : 0.0;
+            }
+            result.duration.addBlock(projectDuration, n);
+            result.success.addBlock(success, n);
+            for(size_t k = 0; k < numberOfTasks; k++) {
+                result.criticality[network.taskAt(k)].addBlock(&critical[k * n], n);
+            }
+        }
+    });
+
+    // Pool the pieces in order
+    ProjectResult total;
+    total.criticality.resize(numberOfTasks);
+    for(const ProjectResult &result : results) {
+        total.duration.merge(result.duration);
+        total.success.merge(result.success);
+        for(size_t t = 0; t < numberOfTasks; t++) {
+            total.criticality[t].merge(result.criticality[t]);
+        }
+    }
+
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "../include/Project.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Read the projects in the in.txt format:
+//
+//     trials
+//     numberOfProjects
+//     then per project: its name on a line, the deadline, the number of tasks,
+//     and a "name predecessors a m b" line per task, the predecessors being
+//     comma separated or - for none
+static bool readProjects(std::istream &in, long &trials, std::vector<ProjectModel> &projects) {
+    int numberOfProjects, numberOfTasks;
+    std::string predecessors, error;
+
+    if(!(in >> trials >> numberOfProjects) || trials < 2 || numberOfProjects < 1) {
+        return false;
+    }
+
+    projects.resize(numberOfProjects);
+    for(ProjectModel &project : projects) {
+        in >> std::ws;
+        if(!std::getline(in, project.name) || !(in >> project.deadline >> numberOfTasks) || numberOfTasks < 1) {
+            return false;
+        }
+
+        project.tasks.resize(numberOfTasks);
+        for(Task &task : project.tasks) {
+            if(!(in >> task.name >> predecessors >> task.lower >> task.mode >> task.upper)) {
+                return false;
+            }
+            if(predecessors != "-") {
+                std::stringstream list(predecessors);
+                std::string name;
+                while(std::getline(list, name, ',')) {
+                    task.predecessors.push_back(name);
+                }
+            }
+        }
+
+        if(!project.network.build(project.tasks, error)) {
+            std::cout << "Error in " << project.name << ": " << error << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const DurationDistribution distributions[] = {DURATION_TRIANGULAR, DURATION_RIGHT_TRIANGULAR, DURATION_LEFT_TRIANGULAR};
+    const char *distributionNames[] = {"Triangular(a, b, m)", "RT(a, b)", "LT(a, b)"};
+    long trials;
+    std::vector<ProjectModel> projects;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("out.txt");
+
+    if(!inFile.is_open() || !outFile.is_open()) {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if(!readProjects(inFile, trials, projects)) {
+        std::cout << "Error: invalid input\n";
+        exit(1);
+    }
+
+    // "./main.out [trials] [threads]" overrides the number of trials and picks the number of threads
+    if(argc > 1) {
+        trials = atol(argv[1]);
+        if(trials < 2) {
+            std::cout << "Error: at least 2 trials are needed\n";
+            exit(1);
+        }
+    }
+    ThreadPool pool(argc > 2 ? (unsigned) atoi(argv[2]) : 0);
+
+    outFile << std::fixed << std::setprecision(4);
+
+    outFile << "------Project Network Simulation------\n\n";
+    outFile << "Number of trials: " << trials << "\n\n";
+
+    for(size_t p = 0; p < projects.size(); p++) {
+        const ProjectModel &project = projects[p];
+        ProjectResult results[3];
+
+        // Each project gets its own substream, and the three distributions of
+        // a project share it, so their results are compared under common random numbers
+        for(int d = 0; d < 3; d++) {
+            results[d] = simulateProject(pool, project, distributions[d], trials, TrialRandGen().substream(p, projects.size()));
+        }
+
+        outFile << "--------------------------------------------------------------------------------------------------\n";
+        outFile << project.name << "\n\n";
+        outFile << "Deadline: " << std::setprecision(2) << project.deadline << "\n\n";
+
+        outFile << "Task  Predecessors         a        m        b\n";
+        for(const Task &task : project.tasks) {
+            std::string predecessors;
+            for(size_t j = 0; j < task.predecessors.size(); j++) {
+                predecessors += (j > 0 ? ", " : "") + task.predecessors[j];
+            }
+            if(predecessors.empty()) {
+                predecessors = "-";
+            }
+            outFile << std::left << std::setw(6) << task.name << std::setw(14) << predecessors << std::right
+                    << std::setw(9) << task.lower << std::setw(9) << task.mode << std::setw(9) << task.upper << "\n";
+        }
+        outFile << std::setprecision(4) << "\n";
+
+        outFile << "Distribution            Average Project Duration           Success Rate\n";
+        for(int d = 0; d < 3; d++) {
+            ConfidenceInterval duration = confidenceInterval(results[d].duration, 0.95);
+            ConfidenceInterval success = confidenceInterval(results[d].success, 0.95);
+
+            outFile << std::left << std::setw(24) << distributionNames[d] << std::right
+                    << std::setw(9) << duration.mean << " +/- " << std::setw(6) << duration.halfLength << " (95%)"
+                    << std::setw(12) << success.mean << " +/- " << std::setw(6) << success.halfLength << "\n";
+        }
+        outFile << "\n";
+
+        outFile << "Criticality index:\n";
+        outFile << "Task  ";
+        for(int d = 0; d < 3; d++) {
+            outFile << std::setw(22) << distributionNames[d];
+        }
+        outFile << "\n";
+        for(size_t t = 0; t < project.tasks.size(); t++) {
+            outFile << std::left << std::setw(6) << project.tasks[t].name << std::right;
+            for(int d = 0; d < 3; d++) {
+                outFile << std::setw(22) << results[d].criticality[t].mean();
+            }
+            outFile << "\n";
+        }
+        outFile << "\n";
+    }
+
+    outFile << "--------------------------------------------------------------------------------------------------";
+
+    return 0;
+}
\ No newline at end of file
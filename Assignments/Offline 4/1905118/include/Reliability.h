@@ -0,0 +1,64 @@
+#ifndef RELIABILITY_H
+#define RELIABILITY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "RandGen.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+// Structure function of a system of components, written as nested
+//
+//     min(...) or series(...)      fails as soon as any argument fails
+//     max(...) or parallel(...)    fails once every argument has failed
+//
+// over component names, e.g. min(max(1, min(2, max(3, 4))), 5).  A component
+// may appear more than once, so any system given by its minimal path sets,
+// max(min(path 1), min(path 2), ...), can be written directly.
+class SystemStructure {
+public:
+    // Parse expression over the given component names; on failure error says why
+    bool parse(const std::string &expression, const std::vector<std::string> &componentNames, std::string &error);
+
+    // Time to failure of n trials at once.  lifetimes[c] holds the n lifetimes
+    // of component c; scratch needs scratchSize(n) doubles.
+    void evaluate(const std::vector<const double *> &lifetimes, double *out, size_t n, double *scratch) const;
+    size_t scratchSize(size_t n) const { return this->nodes.size() * n; }
+
+private:
+    struct Node {
+        bool maximum;                                  // max (parallel) rather than min (series)
+        std::vector<int> children;                     // Node index, or -1 - component index
+    };
+
+    bool parseNode(const std::string &expression, size_t &position, const std::vector<std::string> &componentNames, int &child, std::string &error);
+
+    std::vector<Node> nodes;                           // Children come before their parents; the root is last
+};
+
+// One system: its components with exponential lifetimes, and its structure
+struct ReliabilityModel {
+    std::string name;                                  // Name of the system
+    std::vector<std::string> componentNames;           // Name of each component
+    std::vector<double> meanLifetimes;                 // Mean time to failure of each component
+    std::string expression;                            // Structure as written
+    SystemStructure structure;                         // Parsed structure
+};
+
+struct ReliabilityResult {
+    RunningStat lifetime;                              // System time to failure
+    RunningStat survival;                              // Indicator that the system lasts the mission time
+    std::vector<long> histogram;                       // Trials per bin, the last bin being the overflow
+};
+
+// Estimate the lifetime distribution of model from trials independent trials
+// on pool.  Trials are cut into a fixed number of pieces, each with its own
+// substream of randGen, so the result does not depend on the number of threads.
+// Within a piece component lifetimes are drawn a block at a time into arrays
+// and the structure is applied to the whole block.  Trials draw from
+// TrialRandGen, so 10^8 trials of a large system still get disjoint pieces.
+ReliabilityResult simulateReliability(ThreadPool &pool, const ReliabilityModel &model, long trials, double missionTime,
+                                      double binWidth, int numberOfBins, const TrialRandGen &randGen);
+
+#endif // RELIABILITY_H
\ No newline at end of file
@@ -0,0 +1,8 @@
+clear
+
+rm main.out
+rm out*.txt
+
+g++ -std=c++17 -pthread -fsanitize=address -I../../common/include src/* ../../common/src/* -o main.out
+
+./main.out
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "../include/Reliability.h"
+
+#include <algorithm>
+#include <cctype>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RELIABILITY_X86 1
+#endif
+
+#define RELIABILITY_PIECES 256                         // Most pieces a run is cut into
+
+static void skipSpaces(const std::string &expression, size_t &position) {
+    while(position < expression.size() && isspace((unsigned char) expression[position])) {
+        position++;
+    }
+}
+
+bool SystemStructure::parse(const std::string &expression, const std::vector<std::string> &componentNames, std::string &error) {
+    size_t position = 0;
+    int root;
+
+    this->nodes.clear();
+    if(!this->parseNode(expression, position, componentNames, root, error)) {
+        return false;
+    }
+
+    skipSpaces(expression, position);
+    if(position != expression.size()) {
+        error = "unexpected text after the structure";
+        return false;
+    }
+
+    // A single component is a series system of one
+    if(root < 0) {
+        Node node;
+        node.maximum = false;
+        node.children.push_back(root);
+        this->nodes.push_back(node);
+    }
+
+    return true;
+}
+
+// Parse one name or min/max group into child: a node index, or -1 - component index
+bool SystemStructure::parseNode(const std::string &expression, size_t &position, const std::vector<std::string> &componentNames, int &child, std::string &error) {
+    size_t start;
+
+    skipSpaces(expression, position);
+    start = position;
+    while(position < expression.size() && (isalnum((unsigned char) expression[position]) || expression[position] == '_')) {
+        position++;
+    }
+    std::string word = expression.substr(start, position - start);
+    if(word.empty()) {
+        error = "expected a component name or min/max at position " + std::to_string(start + 1);
+        return false;
+    }
+
+    skipSpaces(expression, position);
+    if(position < expression.size() && expression[position] == '(') {
+        Node node;
+
+        if(word == "min" || word == "series") {
+            node.maximum = false;
+        } else if(word == "max" || word == "parallel") {
+            node.maximum = true;
+        } else {
+            error = "unknown operator " + word;
+            return false;
+        }
+
+        position++;
+        for(;;) {
+            if(!this->parseNode(expression, position, componentNames, child, error)) {
+                return false;
+            }
+            node.children.push_back(child);
+
+            skipSpaces(expression, position);
+            if(position < expression.size() && expression[position] == ',') {
+                position++;
+            } else if(position < expression.size() && expression[position] == ')') {
+                position++;
+                break;
+            } else {
+                error = "expected , or ) at position " + std::to_string(position + 1);
+                return false;
+            }
+        }
+
+        this->nodes.push_back(node);
+        child = (int) this->nodes.size() - 1;
+        return true;
+    }
+
+    for(size_t c = 0; c < componentNames.size(); c++) {
+        if(componentNames[c] == word) {
+            child = -1 - (int) c;
+            return true;
+        }
+    }
+    error = "unknown component " + word;
+    return false;
+}
+
+// Block kernels: dest = min(dest, src) or max(dest, src) elementwise
+
+static void combineScalar(double *dest, const double *src, size_t n, bool maximum) {
+    if(maximum) {
+        for(size_t i = 0; i < n; i++) {
+            dest[i] = std::max(dest[i], src[i]);
+        }
+    } else {
+        for(size_t i = 0; i < n; i++) {
+            dest[i] = std::min(dest[i], src[i]);
+        }
+    }
+}
+
+#ifdef RELIABILITY_X86
+
+__attribute__((target("avx2")))
+static size_t combineAvx2(double *dest, const double *src, size_t n, bool maximum) {
+    size_t i;
+
+    if(maximum) {
+        for(i = 0; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dest + i, _mm256_max_pd(_mm256_loadu_pd(dest + i), _mm256_loadu_pd(src + i)));
+        }
+    } else {
+        for(i = 0; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dest + i, _mm256_min_pd(_mm256_loadu_pd(dest + i), _mm256_loadu_pd(src + i)));
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+static void combine(double *dest, const double *src, size_t n, bool maximum) {
+    size_t done = 0;
+
+#ifdef RELIABILITY_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if(avx2) {
+        done = combineAvx2(dest, src, n, maximum);
+    }
+#endif
+
+    combineScalar(dest + done, src + done, n - done, maximum);
+}
+
+void SystemStructure::evaluate(const std::vector<const double *> &lifetimes, double *out, size_t n, double *scratch) const {
+    // Each node's result goes to its own row of scratch; children are always done first
+    for(size_t k = 0; k < this->nodes.size(); k++) {
+        const Node &node = this->nodes[k];
+        double *result = scratch + k * n;
+
+        for(size_t j = 0; j < node.children.size(); j++) {
+            int child = node.children[j];
+            const double *values = child >= 0 ? scratch + child * n : lifetimes[-1 - child];
+
+            if(j == 0) {
+                std::copy(values, values + n, result);
+            } else {
+                combine(result, values, n, node.maximum);
+            }
+        }
+    }
+
+    std::copy(scratch + (this->nodes.size() - 1) * n, scratch + this->nodes.size() * n, out);
+}
+
+ReliabilityResult simulateReliability(ThreadPool &pool, const ReliabilityModel &model, long trials, double missionTime,
+                                      double binWidth, int numberOfBins, const TrialRandGen &randGen) {
+    size_t numberOfComponents = model.meanLifetimes.size();
+    long pieces = std::min<long>(RELIABILITY_PIECES, (trials + RANDGEN_BLOCK - 1) / RANDGEN_BLOCK);
+    std::vector<ReliabilityResult> results(pieces);
+
+    pool.parallelFor(pieces, [&](size_t p) {
+        ReliabilityResult &result = results[p];
+        TrialRandGen generator = randGen.substream(p, pieces);
+        std::vector<double> lifetimes(numberOfComponents * RANDGEN_BLOCK), scratch(model.structure.scratchSize(RANDGEN_BLOCK));
+        std::vector<const double *> rows(numberOfComponents);
+        double system[RANDGEN_BLOCK], survived[RANDGEN_BLOCK];
+        long first = trials * (long) p / pieces, last = trials * (long) (p + 1) / pieces;
+
+        result.histogram.assign(numberOfBins + 1, 0);
+        for(size_t c = 0; c < numberOfComponents; c++) {
+            rows[c] = &lifetimes[c * RANDGEN_BLOCK];
+        }
+
+        for(long done = first; done < last; done += RANDGEN_BLOCK) {
+            size_t n = (size_t) std::min<long>(RANDGEN_BLOCK, last - done);
+
+            // One block of lifetimes per component, then the structure over the whole block
+            for(size_t c = 0; c < numberOfComponents; c++) {
+                generator.getExponentialBlock(model.meanLifetimes[c], &lifetimes[c * RANDGEN_BLOCK], n);
+            }
+            model.structure.evaluate(rows, system, n, scratch.data());
+
+            for(size_t i = 0; i < n; i++) {
+                survived[i] = system[i] >= missionTime ? 1.0 : 0.0;
+                result.histogram[std::min<long>((long) (system[i] / binWidth), numberOfBins)]++;
+            }
+            result.lifetime.addBlock(system, n);
+            result.survival.addBlock(survived, n);
+        }
+    });
+
+    // Pool the pieces in order
+    ReliabilityResult total;
+    total.histogram.assign(numberOfBins + 1, 0);
+    for(const ReliabilityResult &result : results) {
+        total.lifetime.merge(result.lifetime);
+        total.survival.merge(result.survival);
+        for(int b = 0; b <= numberOfBins; b++) {
+            total.histogram[b] += result.histogram[b];
+        }
+    }
+
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "../include/Reliability.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Read the models in the in.txt format:
+//
+//     trials missionTime
+//     binWidth numberOfBins
+//     numberOfSystems
+//     then per system: its name on a line, the number of components, a
+//     "name meanLifetime" line per component, and the structure on a line
+static bool readModels(std::istream &in, long &trials, double &missionTime, double &binWidth, int &numberOfBins, std::vector<ReliabilityModel> &models) {
+    int numberOfSystems, numberOfComponents;
+    std::string error;
+
+    if(!(in >> trials >> missionTime >> binWidth >> numberOfBins >> numberOfSystems)) {
+        return false;
+    }
+    if(trials < 2 || binWidth <= 0.0 || numberOfBins < 1 || numberOfSystems < 1) {
+        return false;
+    }
+
+    models.resize(numberOfSystems);
+    for(ReliabilityModel &model : models) {
+        in >> std::ws;
+        if(!std::getline(in, model.name) || !(in >> numberOfComponents) || numberOfComponents < 1) {
+            return false;
+        }
+
+        model.componentNames.resize(numberOfComponents);
+        model.meanLifetimes.resize(numberOfComponents);
+        for(int c = 0; c < numberOfComponents; c++) {
+            if(!(in >> model.componentNames[c] >> model.meanLifetimes[c]) || model.meanLifetimes[c] <= 0.0) {
+                return false;
+            }
+        }
+
+        in >> std::ws;
+        if(!std::getline(in, model.expression)) {
+            return false;
+        }
+        if(!model.structure.parse(model.expression, model.componentNames, error)) {
+            std::cout << "Error in the structure of " << model.name << ": " << error << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    long trials;
+    double missionTime, binWidth;
+    int numberOfBins;
+    std::vector<ReliabilityModel> models;
+    std::ifstream inFile("in.txt");
+    std::ofstream outFile("out.txt");
+
+    if(!inFile.is_open() || !outFile.is_open()) {
+        std::cout << "Error opening files\n";
+        exit(1);
+    }
+
+    if(!readModels(inFile, trials, missionTime, binWidth, numberOfBins, models)) {
+        std::cout << "Error: invalid input\n";
+        exit(1);
+    }
+
+    // "./main.out [trials] [threads]" overrides the number of trials and picks the number of threads
+    if(argc > 1) {
+        trials = atol(argv[1]);
+        if(trials < 2) {
+            std::cout << "Error: at least 2 trials are needed\n";
+            exit(1);
+        }
+    }
+    ThreadPool pool(argc > 2 ? (unsigned) atoi(argv[2]) : 0);
+
+    outFile << std::fixed << std::setprecision(4);
+
+    outFile << "------Reliability of Series-Parallel Systems------\n\n";
+    outFile << "Number of trials: " << trials << "\n\n";
+    outFile << "Mission time: " << missionTime << " days\n\n";
+
+    // Each system gets its own substream, one of as many as there are systems
+    for(size_t s = 0; s < models.size(); s++) {
+        const ReliabilityModel &model = models[s];
+        ReliabilityResult result = simulateReliability(pool, model, trials, missionTime, binWidth, numberOfBins, TrialRandGen().substream(s, models.size()));
+        ConfidenceInterval lifetime = confidenceInterval(result.lifetime, 0.95);
+        ConfidenceInterval survival = confidenceInterval(result.survival, 0.95);
+
+        outFile << "--------------------------------------------------------------------------------------------------\n";
+        outFile << model.name << "\n\n";
+        outFile << "Mean time to failure of components (days):";
+        for(size_t c = 0; c < model.componentNames.size(); c++) {
+            outFile << " " << model.componentNames[c] << " = " << std::setprecision(2) << model.meanLifetimes[c];
+        }
+        outFile << std::setprecision(4) << "\n\n";
+        outFile << "Structure: " << model.expression << "\n\n";
+        outFile << "Estimated expected time to failure: " << lifetime.mean << " +/- " << lifetime.halfLength << " days (95%)\n\n";
+        outFile << "Estimated probability of functioning at least " << std::setprecision(2) << missionTime << " days: "
+                << std::setprecision(4) << survival.mean << " +/- " << survival.halfLength << " (95%)\n\n";
+
+        outFile << "Histogram of time to failure:\n";
+        for(int b = 0; b <= numberOfBins; b++) {
+            long count = result.histogram[b];
+            int bar = (int) (60.0 * count / trials + 0.5);
+
+            outFile << std::setprecision(2);
+            if(b < numberOfBins) {
+                outFile << '[' << std::setw(6) << b * binWidth << ", " << std::setw(6) << (b + 1) * binWidth << ')';
+            } else {
+                outFile << '[' << std::setw(6) << b * binWidth << ",    inf)";
+            }
+            outFile << std::setw(12) << count << "  " << std::string(bar, '*') << "\n";
+        }
+        outFile << std::setprecision(4) << "\n";
+    }
+
+    outFile << "--------------------------------------------------------------------------------------------------";
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef EVENTKERNEL_H
+#define EVENTKERNEL_H
+
+// Discrete-event kernel for the event-driven models: the clock, the future
+// event list and the timing / update-statistics / dispatch loop, written once.
+// A model derives from EventKernel<Model, NumberOfEventTypes> and provides
+//
+//     bool done()                                     Stop before the next event?
+//     void accumulate(double elapsed)                 Update the time-average statistics
+//     void handle(EventType<k>, const Event &event)   One overload per event type k
+//
+// The handlers are chosen at compile time (curiously recurring template), so
+// dispatch is a chain of compares on the event type with each handler inlined
+// behind its compare, rather than a call through a pointer.  The kernel needs
+// to see the hooks, so a model that keeps them private makes it a friend.
+
+#include "EventList.h"
+
+// Tag naming event type Type to the handler overloads
+template <int Type>
+struct EventType {};
+
+// How runEvents() stopped
+enum KernelStatus {
+    KERNEL_DONE,                                       // The model asked to stop
+    KERNEL_EVENT_LIST_EMPTY,                           // No event was left to process
+    KERNEL_INVALID_EVENT                               // An event type had no handler
+};
+
+template <class Model, int NumberOfEventTypes, class Queue = EVENTLIST_QUEUE>
+class EventKernel {
+protected:
+    EventKernel() : simulationTime(0.0), timeOfLastEvent(0.0) {}
+
+    // Start again at time 0 with an empty event list, keeping its storage
+    void resetKernel() {
+        this->eventList.clear();
+        this->simulationTime = 0.0;
+        this->timeOfLastEvent = 0.0;
+    }
+
+    // Process events until the model is done
+    KernelStatus runEvents() {
+        Model &model = static_cast<Model &>(*this);
+
+        while(!model.done()) {
+            if(this->eventList.empty()) {
+                return KERNEL_EVENT_LIST_EMPTY;
+            }
+
+            // Determine the next event and advance the simulation clock
+            Event event = this->eventList.next();
+            this->simulationTime = event.time;
+
+            // Update the time-average statistics up to the event, then invoke its handler
+            model.accumulate(this->simulationTime - this->timeOfLastEvent);
+            this->timeOfLastEvent = this->simulationTime;
+
+            if(!dispatch(model, event, EventType<0>())) {
+                return KERNEL_INVALID_EVENT;
+            }
+        }
+
+        return KERNEL_DONE;
+    }
+
+    BasicEventList<Queue> eventList;                   // Future event list
+    double simulationTime;                             // Simulation clock
+    double timeOfLastEvent;                            // Time of the last event processed
+
+private:
+    template <int Type>
+    static bool dispatch(Model &model, const Event &event, EventType<Type>) {
+        if constexpr(Type == NumberOfEventTypes) {
+            return false;
+        } else {
+            if(event.type == Type) {
+                model.handle(EventType<Type>(), event);
+                return true;
+            }
+            return dispatch(model, event, EventType<Type + 1>());
+        }
+    }
+};
+
+#endif // EVENTKERNEL_H
\ No newline at end of file
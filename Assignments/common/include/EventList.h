@@ -0,0 +1,378 @@
+#ifndef EVENTLIST_H
+#define EVENTLIST_H
+
+// Future event list for the discrete-event simulations.  Events are ordered
+// by time, then by event type, then by the order they were scheduled, which
+// is the order the old linear scan over per-type slots produced.
+//
+// schedule() returns a handle that stays valid until the event fires or is
+// cancelled; cancel() and reschedule() return false and change nothing for a
+// handle that is not pending.  Both are lazy: the old queue entry is left
+// in place and skipped when it surfaces, and the queue is compacted once stale
+// entries outnumber live ones.  The queue itself is a policy:
+//
+//     BinaryHeap      O(log n) push and pop
+//     CalendarQueue   amortized O(1) push and pop (Brown 1988) when event
+//                     times are spread evenly, as in large models
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+struct Event {
+    double time;                                       // Time the event occurs
+    int type;                                          // Event type
+    int data;                                          // Model-specific payload (customer, server, ...)
+    int handle;                                        // Handle returned by schedule()
+    unsigned generation;                               // Handle generation the entry was made for
+    unsigned long long sequence;                       // Scheduling order, breaks remaining ties
+};
+
+inline bool eventBefore(const Event &a, const Event &b) {
+    if(a.time != b.time) {
+        return a.time < b.time;
+    }
+    if(a.type != b.type) {
+        return a.type < b.type;
+    }
+    return a.sequence < b.sequence;
+}
+
+class BinaryHeap {
+public:
+    void push(const Event &event) {
+        this->heap.push_back(event);
+        std::push_heap(this->heap.begin(), this->heap.end(), later);
+    }
+
+    const Event &top() { return this->heap.front(); }
+
+    void pop() {
+        std::pop_heap(this->heap.begin(), this->heap.end(), later);
+        this->heap.pop_back();
+    }
+
+    size_t size() const { return this->heap.size(); }
+    void clear() { this->heap.clear(); }
+
+    template <class Pred>
+    void removeIf(Pred stale) {
+        this->heap.erase(std::remove_if(this->heap.begin(), this->heap.end(), stale), this->heap.end());
+        std::make_heap(this->heap.begin(), this->heap.end(), later);
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for(const Event &event : this->heap) {
+            f(event);
+        }
+    }
+
+private:
+    static bool later(const Event &a, const Event &b) { return eventBefore(b, a); }
+
+    std::vector<Event> heap;                           // Min-heap on eventBefore
+};
+
+class CalendarQueue {
+public:
+    CalendarQueue() : width(1.0), count(0), current(0), cached(-1), scanned(0), removed(0) {
+        this->buckets.resize(2);
+    }
+
+    void push(const Event &event) {
+        this->insert(event);
+        this->count++;
+        this->cached = -1;
+
+        // The scan in locate() starts from the current day, so it must not be
+        // later than any queued event
+        if(this->virtualBucket(event.time) < this->current) {
+            this->current = this->virtualBucket(event.time);
+        }
+
+        if(this->count > 2 * this->buckets.size()) {
+            this->resize(2 * this->buckets.size());
+        }
+    }
+
+    const Event &top() { return this->buckets[this->locate()].back(); }
+
+    void pop() {
+        size_t b = this->locate();
+
+        this->current = virtualBucket(this->buckets[b].back().time);
+        this->buckets[b].pop_back();
+        this->count--;
+        this->cached = -1;
+        this->removed++;
+
+        if(this->buckets.size() > 2 && this->count < this->buckets.size() / 2) {
+            this->resize(this->buckets.size() / 2);
+        } else if(this->scanned > 8 * this->removed + 2 * this->buckets.size()) {
+            // The bucket width no longer suits the event times, so re-estimate it
+            this->resize(this->buckets.size());
+        }
+    }
+
+    size_t size() const { return this->count; }
+
+    void clear() {
+        for(std::vector<Event> &bucket : this->buckets) {
+            bucket.clear();
+        }
+        this->width = 1.0;
+        this->count = 0;
+        this->current = 0;
+        this->cached = -1;
+        this->scanned = 0;
+        this->removed = 0;
+    }
+
+    template <class Pred>
+    void removeIf(Pred stale) {
+        this->count = 0;
+        for(std::vector<Event> &bucket : this->buckets) {
+            bucket.erase(std::remove_if(bucket.begin(), bucket.end(), stale), bucket.end());
+            this->count += bucket.size();
+        }
+        this->cached = -1;
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for(const std::vector<Event> &bucket : this->buckets) {
+            for(const Event &event : bucket) {
+                f(event);
+            }
+        }
+    }
+
+private:
+    long long virtualBucket(double time) const {
+        double v = std::floor(time / this->width);
+        return v < 4.0e18 ? (long long) v : (long long) 4.0e18;
+    }
+
+    // Buckets are kept in descending order so the earliest event is at the back
+    void insert(const Event &event) {
+        std::vector<Event> &bucket = this->buckets[(size_t) this->virtualBucket(event.time) & (this->buckets.size() - 1)];
+        bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), event, later), event);
+    }
+
+    static bool later(const Event &a, const Event &b) { return eventBefore(b, a); }
+
+    // Find the bucket holding the earliest event: scan one year of buckets from
+    // the current day, then fall back to a direct search of the bucket heads
+    size_t locate() {
+        if(this->cached >= 0) {
+            return (size_t) this->cached;
+        }
+
+        size_t n = this->buckets.size();
+        for(size_t i = 0; i < n; i++) {
+            size_t b = (size_t) (this->current + (long long) i) & (n - 1);
+            if(!this->buckets[b].empty() && this->virtualBucket(this->buckets[b].back().time) == this->current + (long long) i) {
+                this->cached = (long long) b;
+                this->scanned += i;
+                return b;
+            }
+        }
+        this->scanned += 2 * n;
+
+        size_t best = n;
+        for(size_t b = 0; b < n; b++) {
+            if(!this->buckets[b].empty() && (best == n || eventBefore(this->buckets[b].back(), this->buckets[best].back()))) {
+                best = b;
+            }
+        }
+        this->current = virtualBucket(this->buckets[best].back().time);
+        this->cached = (long long) best;
+        return best;
+    }
+
+    // Rehash into a new number of buckets, with the width set to three times
+    // the average gap between the earliest events
+    void resize(size_t size) {
+        std::vector<Event> events;
+        events.reserve(this->count);
+        this->forEach([&events](const Event &event) { events.push_back(event); });
+
+        size_t sample = std::min<size_t>(events.size(), 25);
+        if(sample > 1) {
+            std::partial_sort(events.begin(), events.begin() + sample, events.end(), eventBefore);
+            double gap = (events[sample - 1].time - events[0].time) / (sample - 1);
+            if(gap > 0.0 && std::isfinite(gap)) {
+                this->width = 3.0 * gap;
+            }
+        }
+
+        this->buckets.assign(size, std::vector<Event>());
+        for(const Event &event : events) {
+            this->insert(event);
+        }
+        this->current = events.empty() ? 0 : virtualBucket(std::min_element(events.begin(), events.end(), eventBefore)->time);
+        this->cached = -1;
+        this->scanned = 0;
+        this->removed = 0;
+    }
+
+    std::vector<std::vector<Event>> buckets;           // Buckets, a power of two of them
+    double width;                                      // Time covered by one bucket
+    size_t count;                                      // Entries in all buckets
+    long long current;                                 // Virtual bucket of the last event removed
+    long long cached;                                  // Bucket of the earliest event, or -1
+    size_t scanned;                                    // Buckets examined by locate() since the last resize
+    size_t removed;                                    // Events removed since the last resize
+};
+
+template <class Queue>
+class BasicEventList {
+public:
+    BasicEventList() : live(0), nextSequence(0) {}
+
+    // Schedule an event and return its handle
+    int schedule(double time, int type, int data = 0) {
+        int handle;
+
+        if(this->freeHandles.empty()) {
+            handle = (int) this->pending.size();
+            this->pending.push_back(false);
+            this->generation.push_back(0);
+            this->handleType.push_back(0);
+            this->handleData.push_back(0);
+        } else {
+            handle = this->freeHandles.back();
+            this->freeHandles.pop_back();
+        }
+
+        this->pending[handle] = true;
+        this->handleType[handle] = type;
+        this->handleData[handle] = data;
+        this->live++;
+        this->enqueue(time, type, data, handle);
+
+        return handle;
+    }
+
+    // Drop a pending event
+    bool cancel(int handle) {
+        if(!this->isPending(handle)) {
+            return false;
+        }
+
+        this->release(handle);
+        this->live--;
+        this->compactIfStale();
+        return true;
+    }
+
+    // Move a pending event to a new time, keeping its handle, type and data
+    bool reschedule(int handle, double time) {
+        if(!this->isPending(handle)) {
+            return false;
+        }
+
+        this->generation[handle]++;
+        this->enqueue(time, this->handleType[handle], this->handleData[handle], handle);
+        this->compactIfStale();
+        return true;
+    }
+
+    bool isPending(int handle) const { return handle >= 0 && handle < (int) this->pending.size() && this->pending[handle]; }
+
+    bool empty() const { return this->live == 0; }
+    size_t size() const { return this->live; }
+
+    // Remove and return the earliest pending event; the list must not be empty
+    Event next() {
+        this->skipStale();
+
+        Event event = this->queue.top();
+        this->queue.pop();
+        this->release(event.handle);
+        this->live--;
+
+        return event;
+    }
+
+    // Time of the earliest pending event; the list must not be empty
+    double peekTime() {
+        this->skipStale();
+        return this->queue.top().time;
+    }
+
+    // Remove every event, keeping the storage
+    void clear() {
+        this->queue.clear();
+        for(size_t h = 0; h < this->pending.size(); h++) {
+            if(this->pending[h]) {
+                this->release((int) h);
+            }
+        }
+        this->live = 0;
+    }
+
+    // Visit every pending event, in no particular order
+    template <class F>
+    void forEach(F f) const {
+        this->queue.forEach([this, &f](const Event &event) {
+            if(this->isCurrent(event)) {
+                f(event);
+            }
+        });
+    }
+
+private:
+    void enqueue(double time, int type, int data, int handle) {
+        Event event;
+
+        event.time = time;
+        event.type = type;
+        event.data = data;
+        event.handle = handle;
+        event.generation = this->generation[handle];
+        event.sequence = this->nextSequence++;
+        this->queue.push(event);
+    }
+
+    bool isCurrent(const Event &event) const {
+        return this->pending[event.handle] && this->generation[event.handle] == event.generation;
+    }
+
+    void release(int handle) {
+        this->pending[handle] = false;
+        this->generation[handle]++;
+        this->freeHandles.push_back(handle);
+    }
+
+    void skipStale() {
+        while(!this->isCurrent(this->queue.top())) {
+            this->queue.pop();
+        }
+    }
+
+    void compactIfStale() {
+        if(this->queue.size() > 64 && this->queue.size() > 2 * this->live) {
+            this->queue.removeIf([this](const Event &event) { return !this->isCurrent(event); });
+        }
+    }
+
+    Queue queue;                                       // Queue entries, including stale ones
+    std::vector<bool> pending;                         // Whether each handle has a pending event
+    std::vector<unsigned> generation;                  // Current generation of each handle
+    std::vector<int> handleType;                       // Event type scheduled under each handle
+    std::vector<int> handleData;                       // Payload scheduled under each handle
+    std::vector<int> freeHandles;                      // Handles available for reuse
+    size_t live;                                       // Number of pending events
+    unsigned long long nextSequence;                   // Sequence number for the next entry
+};
+
+#ifndef EVENTLIST_QUEUE
+#define EVENTLIST_QUEUE BinaryHeap
+#endif
+
+typedef BasicEventList<EVENTLIST_QUEUE> EventList;
+
+#endif // EVENTLIST_H
@@ -0,0 +1,374 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+// Uniform generator policies for RandGen.  Each policy provides
+//
+//     double next();                          U(0,1), never exactly 0 or 1
+//     void fill(double *out, size_t n);       the next n values of next()
+//     G substream(index, count) const;        the index-th of count disjoint pieces
+//                                             of what is left of this sequence;
+//                                             piece 0 starts at the current state
+//     double capacity() const;                draws this generator can take before
+//                                             running into the next piece
+//
+// and is used by value, so every call is resolved at compile time.
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "lcgrand.h"
+
+// The coursework generator: lcgrand with its 24-bit outputs and a period of
+// 2^31 - 2.  Default stream 1 reproduces the reference outputs.
+class LcgGenerator {
+public:
+    explicit LcgGenerator(int stream = 1) : stream(lcgrandstream(stream)), span(PERIOD) {}
+    LcgGenerator(const LcgStream &stream, long long span) : stream(stream), span(span) {}
+
+    double next() { return lcgrand(this->stream); }
+    void fill(double *out, size_t n) { lcgrandfill(this->stream, out, n); }
+
+    // A span of 2^31 - 2 draws leaves no room for more than that many pieces
+    LcgGenerator substream(unsigned long long index, unsigned long long count) const {
+        assert(count > 0 && index < count);
+        long long spacing = this->span / (long long) count;
+        assert(spacing > 0);
+        return LcgGenerator(lcgrandsubstream(this->stream, (long long) index, spacing), spacing);
+    }
+
+    double capacity() const { return (double) this->span; }
+
+    LcgStream &getStream() { return this->stream; }
+
+private:
+    LcgStream stream;                                  // lcgrand state
+    long long span;                                    // Draws reserved for this generator
+};
+
+// xoshiro256++ (Blackman and Vigna), period 2^256 - 1.  Substreams use the
+// published jump polynomials: the first split is spaced 2^192 apart, the
+// second 2^128 apart.  Deeper splits reseed through splitmix64 and are only
+// statistically, not provably, disjoint.  A jump is a linear map of the state
+// over GF(2), so its powers M, M^2, M^4, ... are kept as bit matrices and
+// substream(index) takes O(log index) matrix-vector products, not index jumps.
+class Xoshiro256pp {
+public:
+    explicit Xoshiro256pp(uint64_t seed = 0x9E3779B97F4A7C15ULL) : level(0) {
+        for(int i = 0; i < 4; i++) {
+            this->s[i] = splitmix64(seed);
+        }
+    }
+
+    uint64_t nextRaw() {
+        uint64_t result = rotl(this->s[0] + this->s[3], 23) + this->s[0];
+        uint64_t t = this->s[1] << 17;
+
+        this->s[2] ^= this->s[0];
+        this->s[3] ^= this->s[1];
+        this->s[1] ^= this->s[2];
+        this->s[0] ^= this->s[3];
+        this->s[2] ^= t;
+        this->s[3] = rotl(this->s[3], 45);
+
+        return result;
+    }
+
+    double next() { return ((nextRaw() >> 11) + 0.5) * 0x1.0p-53; }
+
+    void fill(double *out, size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            out[i] = next();
+        }
+    }
+
+    Xoshiro256pp substream(unsigned long long index, unsigned long long count) const {
+        static constexpr uint64_t LongJump[4] = {0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL};
+        static constexpr uint64_t Jump[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        Xoshiro256pp g = *this;
+
+        (void) count;
+        if(this->level < 2) {
+            static const JumpPowers longJumps(LongJump), jumps(Jump);
+            const JumpPowers &powers = this->level == 0 ? longJumps : jumps;
+
+            for(int k = 0; index >> k; k++) {
+                if((index >> k) & 1) {
+                    powers.apply(k, g.s);
+                }
+            }
+        } else if(index > 0) {
+            uint64_t seed = this->s[0] ^ rotl(this->s[1], 13) ^ rotl(this->s[2], 29) ^ rotl(this->s[3], 47) ^ (index * 0xD1B54A32D192ED03ULL);
+            for(int i = 0; i < 4; i++) {
+                g.s[i] = splitmix64(seed);
+            }
+        }
+        g.level = this->level + 1;
+
+        return g;
+    }
+
+    // Reseeded streams are given 2^64, well within their expected distance apart
+    double capacity() const { return std::ldexp(1.0, this->level == 0 ? 256 : this->level == 1 ? 192 : this->level == 2 ? 128 : 64); }
+
+private:
+    // M^(2^k) for k = 0..63, where M is the map jump(polynomial) applies to
+    // the state.  Column j of each power is the image of state bit j.
+    class JumpPowers {
+    public:
+        explicit JumpPowers(const uint64_t *polynomial) : columns(64 * 256 * 4) {
+            for(int j = 0; j < 256; j++) {
+                Xoshiro256pp g;
+
+                for(int w = 0; w < 4; w++) {
+                    g.s[w] = 0;
+                }
+                g.s[j / 64] = 1ULL << (j % 64);
+                g.jump(polynomial);
+                for(int w = 0; w < 4; w++) {
+                    this->columns[j * 4 + w] = g.s[w];
+                }
+            }
+
+            // M^(2^k) e_j = M^(2^(k-1)) (M^(2^(k-1)) e_j)
+            for(int k = 1; k < 64; k++) {
+                for(int j = 0; j < 256; j++) {
+                    uint64_t *column = &this->columns[(k * 256 + j) * 4];
+
+                    for(int w = 0; w < 4; w++) {
+                        column[w] = this->columns[((k - 1) * 256 + j) * 4 + w];
+                    }
+                    this->apply(k - 1, column);
+                }
+            }
+        }
+
+        // state = M^(2^k) state
+        void apply(int k, uint64_t *state) const {
+            const uint64_t *matrix = &this->columns[k * 256 * 4];
+            uint64_t t[4] = {0, 0, 0, 0};
+
+            for(int j = 0; j < 256; j++) {
+                if((state[j / 64] >> (j % 64)) & 1) {
+                    for(int w = 0; w < 4; w++) {
+                        t[w] ^= matrix[j * 4 + w];
+                    }
+                }
+            }
+            for(int w = 0; w < 4; w++) {
+                state[w] = t[w];
+            }
+        }
+
+    private:
+        std::vector<uint64_t> columns;                 // Column j of power k at (k * 256 + j) * 4
+    };
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t splitmix64(uint64_t &x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    void jump(const uint64_t *polynomial) {
+        uint64_t t[4] = {0, 0, 0, 0};
+
+        for(int i = 0; i < 4; i++) {
+            for(int b = 0; b < 64; b++) {
+                if(polynomial[i] & (1ULL << b)) {
+                    for(int k = 0; k < 4; k++) {
+                        t[k] ^= this->s[k];
+                    }
+                }
+                nextRaw();
+            }
+        }
+        for(int k = 0; k < 4; k++) {
+            this->s[k] = t[k];
+        }
+    }
+
+    uint64_t s[4];                                     // Generator state
+    int level;                                         // Number of splits above this generator
+};
+
+// PCG64 (O'Neill): a 128-bit LCG with the XSL-RR output permutation, period
+// 2^128.  The LCG can be advanced by any distance in O(log n), so substreams
+// split the remaining span evenly, as for LcgGenerator.
+class Pcg64 {
+public:
+    typedef unsigned __int128 uint128;
+
+    explicit Pcg64(uint64_t seed = 0x853C49E6748FEA9BULL, uint64_t sequence = 0xDA3E39CB94B95BDBULL)
+        : state(0), increment(((uint128) sequence << 1) | 1), span(~(uint128) 0) {
+        step();
+        this->state += seed;
+        step();
+    }
+
+    uint64_t nextRaw() {
+        step();
+        uint64_t value = (uint64_t) (this->state >> 64) ^ (uint64_t) this->state;
+        unsigned rot = (unsigned) (this->state >> 122);
+        return (value >> rot) | (value << ((-rot) & 63));
+    }
+
+    double next() { return ((nextRaw() >> 11) + 0.5) * 0x1.0p-53; }
+
+    void fill(double *out, size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            out[i] = next();
+        }
+    }
+
+    // Move the state n steps ahead (Brown, "Random number generation with arbitrary strides")
+    void advance(uint128 n) {
+        uint128 accMult = 1, accPlus = 0, curMult = multiplier(), curPlus = this->increment;
+
+        while(n > 0) {
+            if(n & 1) {
+                accMult *= curMult;
+                accPlus = accPlus * curMult + curPlus;
+            }
+            curPlus = (curMult + 1) * curPlus;
+            curMult *= curMult;
+            n >>= 1;
+        }
+        this->state = accMult * this->state + accPlus;
+    }
+
+    Pcg64 substream(unsigned long long index, unsigned long long count) const {
+        assert(count > 0 && index < count);
+        Pcg64 g = *this;
+
+        g.span = this->span / count;
+        g.advance(g.span * index);
+        return g;
+    }
+
+    double capacity() const { return (double) this->span; }
+
+private:
+    static uint128 multiplier() { return ((uint128) 2549297995355413924ULL << 64) | 4865540595714422341ULL; }
+
+    void step() { this->state = this->state * multiplier() + this->increment; }
+
+    uint128 state;                                     // LCG state
+    uint128 increment;                                 // LCG increment, odd
+    uint128 span;                                      // Steps reserved for this generator
+};
+
+// MRG32k3a (L'Ecuyer), a combined multiple recursive generator with period
+// about 2^191.  Like PCG64 it is advanced with a matrix power in O(log n);
+// the root generator spans one 2^127-long RngStreams stream.
+class Mrg32k3a {
+public:
+    typedef unsigned __int128 uint128;
+
+    explicit Mrg32k3a(uint64_t seed = 12345) : span((uint128) 1 << 127) {
+        for(int i = 0; i < 3; i++) {
+            this->s1[i] = seed % M1;
+            this->s2[i] = seed % M2;
+        }
+    }
+
+    double next() {
+        int64_t p1 = ((int64_t) (A12 * this->s1[1]) - (int64_t) (A13N * this->s1[0])) % (int64_t) M1;
+        int64_t p2 = ((int64_t) (A21 * this->s2[2]) - (int64_t) (A23N * this->s2[0])) % (int64_t) M2;
+
+        if(p1 < 0) {
+            p1 += M1;
+        }
+        if(p2 < 0) {
+            p2 += M2;
+        }
+
+        this->s1[0] = this->s1[1]; this->s1[1] = this->s1[2]; this->s1[2] = (uint64_t) p1;
+        this->s2[0] = this->s2[1]; this->s2[1] = this->s2[2]; this->s2[2] = (uint64_t) p2;
+
+        return (p1 > p2 ? (p1 - p2) : (p1 - p2 + (int64_t) M1)) * 2.328306549295727688e-10;
+    }
+
+    void fill(double *out, size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            out[i] = next();
+        }
+    }
+
+    // Move both components n steps ahead by multiplying with A^n
+    void advance(uint128 n) {
+        uint64_t a1[3][3] = {{0, 1, 0}, {0, 0, 1}, {M1 - A13N, A12, 0}};
+        uint64_t a2[3][3] = {{0, 1, 0}, {0, 0, 1}, {M2 - A23N, 0, A21}};
+
+        while(n > 0) {
+            if(n & 1) {
+                apply(a1, this->s1, M1);
+                apply(a2, this->s2, M2);
+            }
+            square(a1, M1);
+            square(a2, M2);
+            n >>= 1;
+        }
+    }
+
+    Mrg32k3a substream(unsigned long long index, unsigned long long count) const {
+        assert(count > 0 && index < count);
+        Mrg32k3a g = *this;
+
+        g.span = this->span / count;
+        g.advance(g.span * index);
+        return g;
+    }
+
+    double capacity() const { return (double) this->span; }
+
+private:
+    static constexpr uint64_t M1 = 4294967087ULL;
+    static constexpr uint64_t M2 = 4294944443ULL;
+    static constexpr uint64_t A12 = 1403580;
+    static constexpr uint64_t A13N = 810728;
+    static constexpr uint64_t A21 = 527612;
+    static constexpr uint64_t A23N = 1370589;
+
+    static void apply(const uint64_t a[3][3], uint64_t *s, uint64_t m) {
+        uint64_t t[3];
+
+        for(int i = 0; i < 3; i++) {
+            t[i] = 0;
+            for(int j = 0; j < 3; j++) {
+                t[i] = (t[i] + a[i][j] * s[j] % m) % m;
+            }
+        }
+        for(int i = 0; i < 3; i++) {
+            s[i] = t[i];
+        }
+    }
+
+    static void square(uint64_t a[3][3], uint64_t m) {
+        uint64_t t[3][3];
+
+        for(int i = 0; i < 3; i++) {
+            for(int j = 0; j < 3; j++) {
+                t[i][j] = 0;
+                for(int k = 0; k < 3; k++) {
+                    t[i][j] = (t[i][j] + a[i][k] * a[k][j] % m) % m;
+                }
+            }
+        }
+        for(int i = 0; i < 3; i++) {
+            for(int j = 0; j < 3; j++) {
+                a[i][j] = t[i][j];
+            }
+        }
+    }
+
+    uint64_t s1[3];                                    // First component state
+    uint64_t s2[3];                                    // Second component state
+    uint128 span;                                      // Steps reserved for this generator
+};
+
+#endif // GENERATORS_H
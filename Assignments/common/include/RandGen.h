@@ -0,0 +1,257 @@
+#ifndef RANDGEN_H
+#define RANDGEN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "Generators.h"
+
+#define RANDGEN_BLOCK 256                              // Values prefetched per refill
+#define RANDGEN_SUBSTREAMS 8                           // Pieces a generator can be split into
+
+enum SamplingMode {
+    SAMPLING_REFERENCE,                                // One inverse-transform draw per call from the shared stream
+    SAMPLING_BATCHED                                   // Blocks of draws from a dedicated substream
+};
+
+// Guide table (Chen and Asau) over a discrete cumulative distribution.  Gives
+// the same value as a linear search of the cumulative probabilities for every
+// u, but starts the search at guide[floor(u * n)], so a draw takes O(1)
+// expected comparisons however many values the distribution has.
+class GuideTable {
+public:
+    GuideTable();
+    void build(const std::vector<double> &cumulativeProbabilities);
+
+    int lookup(double u) const {
+        int i = this->guide[(size_t) (u * this->guide.size())];
+
+        while(i < this->last && u >= this->cumulative[i]) {
+            i++;
+        }
+
+        return i + 1;
+    }
+
+private:
+    std::vector<double> cumulative;                    // Cumulative probabilities
+    std::vector<int> guide;                            // First candidate index per guide cell
+    int last;                                          // Index of the last value
+};
+
+// Natural log of a block of values in (0, 1], in place, without calling libm
+void logBlock(double *x, size_t n);
+
+// Triangular(a, b, m) from a block of uniforms, in place, by inverse transform
+void triangularBlock(double *x, size_t n, double a, double m, double b);
+
+// Variate generation over a uniform generator policy (see Generators.h).
+// The policy is a template parameter so the hot path has no virtual calls.
+template <class Generator>
+class BasicRandGen {
+public:
+    explicit BasicRandGen(const Generator &generator = Generator()) : generator(generator) {}
+
+    double getExponential(double mean) { return -mean * log(this->generator.next()); }
+    double getUniform(double a, double b) { return a + (b - a) * this->generator.next(); }
+    int getRandomInt(const GuideTable &table) { return table.lookup(this->generator.next()); }
+
+    // Triangular(a, b, m) by inverse transform, and the right and left
+    // triangular RT(a, b) and LT(a, b) as the larger and smaller of two uniforms
+    double getTriangular(double a, double m, double b) {
+        double u = this->generator.next();
+        double c = a == b ? 0.0 : (m - a) / (b - a);
+
+        return a + (b - a) * (c < u ? 1.0 - sqrt((1.0 - c) * (1.0 - u)) : sqrt(c * u));
+    }
+
+    double getRightTriangular(double a, double b) {
+        double u1 = this->generator.next();
+        double u2 = this->generator.next();
+
+        return a + (b - a) * std::max(u1, u2);
+    }
+
+    double getLeftTriangular(double a, double b) {
+        double u1 = this->generator.next();
+        double u2 = this->generator.next();
+
+        return a + (b - a) * std::min(u1, u2);
+    }
+
+    // Poisson(mean).  Below mean 10, inversion by sequential search from 0 with
+    // one uniform; above, Hormann's transformed rejection with squeeze (PTRS),
+    // which takes about 1.1 pairs of uniforms however large the mean is
+    long getPoisson(double mean) {
+        if(mean < 10.0) {
+            double u = this->generator.next();
+            double p = exp(-mean), f = p;
+            long k = 0;
+
+            while(u > f && p > 0.0) {
+                k++;
+                p *= mean / k;
+                f += p;
+            }
+
+            return k;
+        }
+
+        double sqrtMean = sqrt(mean), logMean = log(mean);
+        double b = 0.931 + 2.53 * sqrtMean, a = -0.059 + 0.02483 * b;
+        double invAlpha = 1.1239 + 1.1328 / (b - 3.4), vr = 0.9277 - 3.6224 / (b - 2.0);
+
+        for(;;) {
+            double u = this->generator.next() - 0.5;
+            double v = this->generator.next();
+            double us = 0.5 - fabs(u);
+            long k = (long) floor((2.0 * a / us + b) * u + mean + 0.43);
+
+            if(us >= 0.07 && v <= vr) {
+                return k;
+            }
+            if(k < 0 || (us < 0.013 && v > us)) {
+                continue;
+            }
+            if(log(v) + log(invAlpha) - log(a / (us * us) + b) <= -mean + k * logMean - lgamma(k + 1.0)) {
+                return k;
+            }
+        }
+    }
+
+    int getRandomInt(std::vector<double> &probability_distribution) {
+        double u = this->generator.next();
+        int i = 0;
+
+        for(i = 0; i < (int) probability_distribution.size() - 1 && u >= probability_distribution[i]; i++) {
+            ;
+        }
+
+        return i + 1;
+    }
+
+    void getUniformBlock(double *out, size_t n) { this->generator.fill(out, n); }
+
+    void getExponentialBlock(double mean, double *out, size_t n) {
+        this->generator.fill(out, n);
+        logBlock(out, n);
+
+        for(size_t i = 0; i < n; i++) {
+            out[i] = -mean * out[i];
+        }
+    }
+
+    void getTriangularBlock(double a, double m, double b, double *out, size_t n) {
+        this->generator.fill(out, n);
+        triangularBlock(out, n, a, m, b);
+    }
+
+    // The two-uniform forms draw all the U1 of up to RANDGEN_BLOCK values, then
+    // all the U2, so they match the scalar calls in distribution but not value by value
+    void getRightTriangularBlock(double a, double b, double *out, size_t n) { this->getExtremeBlock(a, b, out, n, true); }
+    void getLeftTriangularBlock(double a, double b, double *out, size_t n) { this->getExtremeBlock(a, b, out, n, false); }
+
+    // Generator over the index-th of RANDGEN_SUBSTREAMS disjoint pieces of this one's
+    // sequence; piece 0 is the part this generator draws from itself
+    BasicRandGen split(int index) const { return BasicRandGen(this->generator.substream(index, RANDGEN_SUBSTREAMS)); }
+
+    // Generator over the index-th of count disjoint pieces of this one's sequence,
+    // e.g. one piece per replication
+    BasicRandGen substream(unsigned long long index, unsigned long long count) const {
+        return BasicRandGen(this->generator.substream(index, count));
+    }
+
+    // Draws this generator can supply before running into the next substream
+    double capacity() const { return this->generator.capacity(); }
+
+    Generator &getGenerator() { return this->generator; }
+
+private:
+    void getExtremeBlock(double a, double b, double *out, size_t n, bool maximum) {
+        double second[RANDGEN_BLOCK];
+
+        for(size_t done = 0; done < n; done += RANDGEN_BLOCK) {
+            size_t count = std::min<size_t>(RANDGEN_BLOCK, n - done);
+            double *first = out + done;
+
+            this->generator.fill(first, count);
+            this->generator.fill(second, count);
+            if(maximum) {
+                for(size_t i = 0; i < count; i++) {
+                    first[i] = a + (b - a) * std::max(first[i], second[i]);
+                }
+            } else {
+                for(size_t i = 0; i < count; i++) {
+                    first[i] = a + (b - a) * std::min(first[i], second[i]);
+                }
+            }
+        }
+    }
+
+    Generator generator;                               // Uniform generator
+};
+
+template <class Generator>
+class BasicExponentialBuffer {
+public:
+    BasicExponentialBuffer() : shared(nullptr), mode(SAMPLING_REFERENCE), mean(0.0), position(RANDGEN_BLOCK) {}
+
+    void init(BasicRandGen<Generator> &randGen, double mean, SamplingMode mode, int substream) {
+        this->shared = &randGen;
+        this->own = randGen.split(substream);
+        this->mode = mode;
+        this->mean = mean;
+        this->position = RANDGEN_BLOCK;
+    }
+
+    double next() {
+        if(this->mode == SAMPLING_REFERENCE) {
+            return this->shared->getExponential(this->mean);
+        }
+        if(this->position == RANDGEN_BLOCK) {
+            this->own.getExponentialBlock(this->mean, this->values, RANDGEN_BLOCK);
+            this->position = 0;
+        }
+        return this->values[this->position++];
+    }
+
+    // Write out and read back the batched substream and the values prefetched
+    // from it, for checkpoints (see BatchMeans::save); restore() follows init()
+    template <class Writer>
+    void save(Writer &out) const {
+        out.put(this->own);
+        out.put(this->position);
+        out.put(this->values);
+    }
+
+    template <class Reader>
+    bool restore(Reader &in) {
+        return in.get(this->own) && in.get(this->position) && in.get(this->values) && this->position >= 0 && this->position <= RANDGEN_BLOCK;
+    }
+
+private:
+    BasicRandGen<Generator> *shared;                   // Generator used in reference mode
+    BasicRandGen<Generator> own;                       // Substream used in batched mode
+    SamplingMode mode;                                 // Sampling mode
+    double mean;                                       // Mean of the distribution
+    int position;                                      // Next unread value in values
+    double values[RANDGEN_BLOCK];                      // Prefetched variates
+};
+
+// The generator used by the simulations.  lcgrand reproduces the coursework
+// outputs; build with e.g. -DRANDGEN_GENERATOR=Xoshiro256pp for long runs.
+#ifndef RANDGEN_GENERATOR
+#define RANDGEN_GENERATOR LcgGenerator
+#endif
+
+typedef BasicRandGen<RANDGEN_GENERATOR> RandGen;
+typedef BasicExponentialBuffer<RANDGEN_GENERATOR> ExponentialBuffer;
+
+// Generator for the Monte Carlo engines, whichever RANDGEN_GENERATOR is.  They
+// take tens of uniforms per trial for up to 10^8 trials, more than the pieces
+// of lcgrand's 2^31 - 2 draws can hold without overlapping, while PCG64 gives
+// every piece of count a span of 2^128 / count.
+typedef BasicRandGen<Pcg64> TrialRandGen;
+
+#endif // RANDGEN_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstddef>
+#include <vector>
+#include "RandGen.h"
+#include "ThreadPool.h"
+
+// Run n independent replications on the pool.  Replication r is given
+// substream r of n of base, so replications never share random numbers and
+// the results do not depend on how many threads run them.  replicate takes a
+// RandGen and returns the replication's Result; results come back in order.
+//
+// Substreams are disjoint only while each replication stays within its share
+// of base, replicationBudget() draws.  The replications do not count their
+// draws, so a front-end checks its model's expected draws against the budget
+// before running, and refuses rather than let replications overlap.
+template <class Result, class Replicate>
+std::vector<Result> runReplications(ThreadPool &pool, size_t n, const RandGen &base, Replicate replicate) {
+    std::vector<Result> results(n);
+
+    pool.parallelFor(n, [&](size_t r) {
+        results[r] = replicate(base.substream(r, n));
+    });
+
+    return results;
+}
+
+// Uniforms one stream of a replication may take when base is cut into n
+// substreams.  In SAMPLING_BATCHED mode each distribution draws from its own
+// split() piece, so a stream gets 1 / RANDGEN_SUBSTREAMS of the substream.
+inline double replicationBudget(const RandGen &base, size_t n, SamplingMode mode) {
+    double capacity = base.substream(0, n).capacity();
+
+    return mode == SAMPLING_BATCHED ? capacity / RANDGEN_SUBSTREAMS : capacity;
+}
+
+#endif // REPLICATION_H
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef SEQUENTIAL_H
+#define SEQUENTIAL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "RandGen.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+// Sequential procedure for a fixed precision (Law, section 9.4.1): keep adding
+// independent replications until the 100 * confidence percent t interval is
+// tight enough, instead of fixing the number of runs up front.
+//
+//     absolute error beta:  stop at the first n >= minRuns with delta(n) <= beta
+//     relative error gamma: stop at the first n >= minRuns with
+//                           delta(n) / |mean(n)| <= gamma / (1 + gamma)
+//
+// where delta(n) is the half-length.  The adjusted gamma / (1 + gamma) makes
+// the actual relative error at most gamma.
+
+enum PrecisionTarget {
+    PRECISION_ABSOLUTE,                                // Half-length at most precision
+    PRECISION_RELATIVE                                 // Half-length over |mean| at most precision / (1 + precision)
+};
+
+struct StoppingRule {
+    PrecisionTarget target;                            // Kind of precision asked for
+    double precision;                                  // beta or gamma
+    double confidence;                                 // 1 - alpha
+    size_t minRuns;                                    // Runs before the first check, n0
+    size_t maxRuns;                                    // Give up after this many runs
+};
+
+template <class Result>
+struct SequentialRun {
+    std::vector<Result> results;                       // Replications used, in order
+    std::vector<RunningStat> stats;                    // Running moments of each measure
+    bool converged;                                    // Whether every measure met the target
+};
+
+// Whether the interval of stat meets rule
+inline bool precisionMet(const RunningStat &stat, const StoppingRule &rule) {
+    ConfidenceInterval ci = confidenceInterval(stat, rule.confidence);
+
+    if(rule.target == PRECISION_ABSOLUTE) {
+        return ci.halfLength <= rule.precision;
+    }
+    return ci.halfLength <= rule.precision / (1.0 + rule.precision) * std::fabs(ci.mean);
+}
+
+// Run replications until every measure meets rule.  replicate(RandGen) runs
+// one replication and returns its Result; measures(result) returns the values
+// the rule is applied to.  Replication r uses substream r of rule.maxRuns of
+// base.  Replications run a pool-sized round at a time, but the rule is
+// checked after each one in order and later ones of the round are dropped,
+// so the stopping point does not depend on the number of threads.
+template <class Result, class Replicate, class Measures>
+SequentialRun<Result> runSequential(ThreadPool &pool, const StoppingRule &rule, const RandGen &base, Replicate replicate, Measures measures) {
+    SequentialRun<Result> run;
+    std::vector<Result> round;
+
+    run.converged = false;
+
+    for(size_t first = 0; first < rule.maxRuns && !run.converged; first += round.size()) {
+        size_t count = std::min<size_t>(pool.size(), rule.maxRuns - first);
+        if(run.results.size() < rule.minRuns) {
+            count = std::max(count, std::min(rule.minRuns, rule.maxRuns) - first);
+        }
+
+        round.assign(count, Result());
+        pool.parallelFor(count, [&](size_t i) {
+            round[i] = replicate(base.substream(first + i, rule.maxRuns));
+        });
+
+        for(size_t i = 0; i < count && !run.converged; i++) {
+            std::vector<double> values = measures(round[i]);
+
+            run.stats.resize(values.size());
+            for(size_t k = 0; k < values.size(); k++) {
+                run.stats[k].add(values[k]);
+            }
+            run.results.push_back(round[i]);
+
+            if(run.results.size() >= rule.minRuns && run.results.size() >= 2) {
+                run.converged = true;
+                for(const RunningStat &stat : run.stats) {
+                    run.converged = run.converged && precisionMet(stat, rule);
+                }
+            }
+        }
+    }
+
+    return run;
+}
+
+#endif // SEQUENTIAL_H
\ No newline at end of file
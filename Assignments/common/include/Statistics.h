@@ -0,0 +1,159 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+// Output analysis shared by the simulations: running moments, t-based
+// confidence intervals, and the steady-state estimators that give a valid
+// interval from a single long run (batch means) or from independent
+// regeneration cycles (ratio estimator).
+
+#include <cstddef>
+#include <vector>
+
+// Count, mean and variance of a sequence of observations, updated in O(1)
+// per observation with Welford's method.  Two accumulators over disjoint
+// observations can be merged (Chan, Golub and LeVeque).
+class RunningStat {
+public:
+    RunningStat() : n(0), average(0.0), m2(0.0) {}
+
+    void add(double x) {
+        this->n++;
+        double delta = x - this->average;
+        this->average += delta / this->n;
+        this->m2 += delta * (x - this->average);
+    }
+
+    // Add n observations at once; the block gets a two-pass mean and variance, then is merged in
+    void addBlock(const double *x, size_t n);
+
+    void merge(const RunningStat &other);
+    void clear() { *this = RunningStat(); }
+
+    long count() const { return this->n; }
+    double mean() const { return this->average; }
+    double variance() const { return this->n > 1 ? this->m2 / (this->n - 1) : 0.0; }
+
+private:
+    long n;                                            // Number of observations
+    double average;                                    // Mean of the observations
+    double m2;                                         // Sum of squared deviations from the mean
+};
+
+// Batch means over a stream of correlated observations, in O(1) memory.
+// Between batches and 2 * batches complete batch means are kept; when there
+// would be 2 * batches, adjacent pairs are merged and the batch size doubles,
+// so the batches grow with the run as the method needs (Fishman's LBATCH
+// idea, without its tests).  The observations of the unfinished batch are
+// left out of the interval.
+class BatchMeans {
+public:
+    explicit BatchMeans(int batches = 32);
+
+    void add(double x) {
+        this->n++;
+        this->partial += x;
+        if(++this->inBatch == this->size) {
+            this->closeBatch();
+        }
+    }
+
+    void clear();
+
+    long count() const { return this->n; }
+    long batchSize() const { return this->size; }
+    int numberOfBatches() const { return (int) this->means.size(); }
+
+    // Lag-1 correlation of the batch means; near 0 when batches are long enough
+    double lag1Correlation() const;
+
+    // Statistics of the complete batch means
+    RunningStat batchStat() const;
+
+    // Write out and read back the whole state, for checkpoints.  Writer and
+    // Reader have put() and get() overloads for plain values and vectors;
+    // restore() is false if the reader runs out.
+    template <class Writer>
+    void save(Writer &out) const {
+        out.put(this->batches);
+        out.put(this->means);
+        out.put(this->partial);
+        out.put(this->inBatch);
+        out.put(this->size);
+        out.put(this->n);
+    }
+
+    template <class Reader>
+    bool restore(Reader &in) {
+        return in.get(this->batches) && in.get(this->means) && in.get(this->partial) && in.get(this->inBatch) && in.get(this->size) &&
+               in.get(this->n);
+    }
+
+private:
+    void closeBatch();
+
+    int batches;                                       // Batches kept after a merge
+    std::vector<double> means;                         // Means of the complete batches
+    double partial;                                    // Sum over the unfinished batch
+    long inBatch;                                      // Observations in the unfinished batch
+    long size;                                         // Current batch size
+    long n;                                            // Number of observations
+};
+
+// Ratio of means r = E[Y] / E[X] from independent pairs (Y, X), the
+// regenerative estimator when each pair is one cycle's total of a quantity
+// and its length (or customer count).  Co-moments are updated in O(1) per
+// pair with Welford's method and can be merged across threads.
+class RatioStat {
+public:
+    RatioStat() : n(0), meanY(0.0), meanX(0.0), cYY(0.0), cXX(0.0), cXY(0.0) {}
+
+    void add(double y, double x) {
+        this->n++;
+        double dy = y - this->meanY;
+        double dx = x - this->meanX;
+        this->meanY += dy / this->n;
+        this->meanX += dx / this->n;
+        this->cYY += dy * (y - this->meanY);
+        this->cXX += dx * (x - this->meanX);
+        this->cXY += dy * (x - this->meanX);
+    }
+
+    void merge(const RatioStat &other);
+    void clear() { *this = RatioStat(); }
+
+    long count() const { return this->n; }
+    double ratio() const { return this->meanX != 0.0 ? this->meanY / this->meanX : 0.0; }
+
+    // Variance of Y - r X, the quantity the ratio's interval is built on
+    double residualVariance() const;
+    double meanDenominator() const { return this->meanX; }
+
+private:
+    long n;                                            // Number of pairs
+    double meanY;                                      // Mean of the numerators
+    double meanX;                                      // Mean of the denominators
+    double cYY;                                        // Sum of squared deviations of Y
+    double cXX;                                        // Sum of squared deviations of X
+    double cXY;                                        // Sum of cross deviations
+};
+
+// Mean with the half-length of a 100 * confidence percent interval around it
+struct ConfidenceInterval {
+    double mean;                                       // Point estimate
+    double halfLength;                                 // Half-length of the interval
+    long n;                                            // Number of observations behind it
+};
+
+// Student t quantile: P(T <= t) = p for T with df degrees of freedom
+double studentTQuantile(double p, long df);
+
+// Interval for the mean of independent observations, from their t statistic
+ConfidenceInterval confidenceInterval(const RunningStat &stat, double confidence);
+
+// Interval for the steady-state mean from the complete batch means
+ConfidenceInterval confidenceInterval(const BatchMeans &batches, double confidence);
+
+// Interval for the ratio (Law, section 9.5.3, with a t quantile)
+ConfidenceInterval confidenceInterval(const RatioStat &stat, double confidence);
+
+#endif // STATISTICS_H
\ No newline at end of file
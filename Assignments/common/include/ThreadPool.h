@@ -0,0 +1,103 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run parallel loops.  parallelFor hands out
+// loop indices one at a time from an atomic counter, so uneven iterations
+// (replications of different lengths) still keep every core busy.  The calling
+// thread works too, so a pool of size 1 runs the loop without any workers.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0) : jobSize(0), nextIndex(0), active(0), generation(0), stopping(false) {
+        if(threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        for(unsigned i = 1; i < threads; i++) {
+            this->workers.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+        for(std::thread &worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return (unsigned) this->workers.size() + 1; }
+
+    // Call body(i) for every i in [0, n) and return when all calls are done
+    void parallelFor(size_t n, const std::function<void(size_t)> &body) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->job = body;
+            this->jobSize = n;
+            this->nextIndex = 0;
+            this->active = this->workers.size();
+            this->generation++;
+        }
+        this->wake.notify_all();
+
+        this->runJob();
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->done.wait(lock, [this] { return this->active == 0; });
+        this->job = nullptr;
+    }
+
+private:
+    void runJob() {
+        for(size_t i = this->nextIndex++; i < this->jobSize; i = this->nextIndex++) {
+            this->job(i);
+        }
+    }
+
+    void work() {
+        unsigned long long seen = 0;
+
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->wake.wait(lock, [this, seen] { return this->stopping || this->generation != seen; });
+                if(this->stopping) {
+                    return;
+                }
+                seen = this->generation;
+            }
+
+            this->runJob();
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if(--this->active == 0) {
+                this->done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;                  // Worker threads
+    std::mutex mutex;                                  // Guards the job and the counters below
+    std::condition_variable wake;                      // Signals a new job or shutdown
+    std::condition_variable done;                      // Signals that all workers finished the job
+    std::function<void(size_t)> job;                   // Loop body of the current job
+    size_t jobSize;                                    // Number of iterations of the current job
+    std::atomic<size_t> nextIndex;                     // Next iteration to hand out
+    size_t active;                                     // Workers still running the current job
+    unsigned long long generation;                     // Number of jobs started
+    bool stopping;                                     // Set when the pool is destroyed
+};
+
+#endif // THREADPOOL_H
\ No newline at end of file
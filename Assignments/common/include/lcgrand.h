@@ -0,0 +1,91 @@
+#ifndef LCGRAND_H
+#define LCGRAND_H
+
+/* Define the constants. */
+
+#define MODLUS 2147483647
+#define MULT1 24112
+#define MULT2 26143
+#define MULT 630360016   /* MULT1 * MULT2 (mod MODLUS), one full lcgrand step */
+#define PERIOD 2147483646 /* Period of every stream, MODLUS - 1 */
+
+#include <cstddef>
+#include <vector>
+
+/* State of one lcgrand stream.  Every generator owns its own copy, so
+   streams held by different objects can be advanced concurrently. */
+
+struct LcgStream
+{
+    long seed;  /* Seed the stream started from */
+    long zi;    /* Most recently generated integer */
+    int id;     /* Stream number in the default seed table */
+};
+
+/* Make a stream starting from the default seed of stream "stream". */
+
+LcgStream lcgrandstream(int stream);
+
+/* Generate the next random number from an owned stream. */
+
+inline double lcgrand(LcgStream &stream)
+{
+    long zi, lowprd, hi31;
+
+    zi = stream.zi;
+    lowprd = (zi & 65535) * MULT1;
+    hi31 = (zi >> 16) * MULT1 + (lowprd >> 16);
+    zi = ((lowprd & 65535) - MODLUS) +
+         ((hi31 & 32767) << 16) + (hi31 >> 15);
+    if (zi < 0)
+        zi += MODLUS;
+    lowprd = (zi & 65535) * MULT2;
+    hi31 = (zi >> 16) * MULT2 + (lowprd >> 16);
+    zi = ((lowprd & 65535) - MODLUS) +
+         ((hi31 & 32767) << 16) + (hi31 >> 15);
+    if (zi < 0)
+        zi += MODLUS;
+    stream.zi = zi;
+    return (zi >> 7 | 1) / 16777216.0;
+}
+
+/* Skip-ahead.  lcgrandjump advances a stream by n draws in O(log n) time;
+   counts are taken modulo PERIOD, so a negative n moves the stream back.
+   lcgrandsubstream returns the stream that starts index * spacing draws after
+   base, and lcgrandsubstreams returns count such streams.  Substreams of one
+   base never overlap as long as count * spacing <= PERIOD, so at most
+   lcgrandmaxsubstreams(spacing) of them are handed out. */
+
+void lcgrandjump(LcgStream &stream, long long n);
+LcgStream lcgrandsubstream(const LcgStream &base, long long index, long long spacing);
+std::vector<LcgStream> lcgrandsubstreams(const LcgStream &base, long long count, long long spacing);
+long long lcgrandmaxsubstreams(long long spacing);
+
+/* Write the next n random numbers of a stream to out.  The values and the
+   final state are exactly those of n calls to lcgrand(stream); the bulk of
+   the block is produced by several leapfrogged lanes in SIMD registers. */
+
+void lcgrandfill(LcgStream &stream, double *out, size_t n);
+
+/* Block paths of lcgrandfill, which picks the fastest one the machine
+   supports.  lcgrandfillcheck(path) compares a path against repeated lcgrand
+   calls for several block lengths and returns false on any difference. */
+
+enum LcgFillPath
+{
+    LCGFILL_SCALAR,
+    LCGFILL_SSE2,
+    LCGFILL_AVX2
+};
+
+bool lcgrandfillsupported(LcgFillPath path);
+bool lcgrandfillcheck(LcgFillPath path);
+
+/* Compatibility interface on the shared table of 100 streams.  Not safe to
+   call from more than one thread. */
+
+double lcgrand(int stream);
+void lcgrandst(long zset, int stream);
+long lcgrandgt(int stream);
+
+#endif // LCGRAND_H
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "../include/RandGen.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define RANDGEN_X86 1
+#endif
+
+GuideTable::GuideTable() : last(0) {}
+
+void GuideTable::build(const std::vector<double> &cumulativeProbabilities) {
+    size_t n = cumulativeProbabilities.size();
+
+    this->cumulative = cumulativeProbabilities;
+    this->guide.assign(n, 0);
+    this->last = (int) n - 1;
+
+    // guide[j] is the first value with F * n >= j, so every u in [j / n, (j + 1) / n)
+    // is answered at or after it, with rounding working in the same direction as u * n
+    int i = 0;
+    for(size_t j = 0; j < n; j++) {
+        while(i < this->last && this->cumulative[i] * n < j) {
+            i++;
+        }
+        this->guide[j] = i;
+    }
+}
+
+// Natural log of a block of positive, normal doubles, in place.  This is the
+// fdlibm __ieee754_log reduction and polynomial without its special cases:
+// x = 2^k * m with m in [sqrt(2)/2, sqrt(2)), f = m - 1, s = f / (2 + f) and
+// log(1 + f) = f - hfsq + s * (hfsq + R(s^2)), accurate to under 1 ulp.  The
+// AVX2 and scalar versions do the same operations in the same order, so they
+// give identical results.
+
+static const double Ln2Hi = 6.93147180369123816490e-01;
+static const double Ln2Lo = 1.90821492927058770002e-10;
+static const double Lg1 = 6.666666666666735130e-01;
+static const double Lg2 = 3.999999999940941908e-01;
+static const double Lg3 = 2.857142874366239149e-01;
+static const double Lg4 = 2.222219843214978396e-01;
+static const double Lg5 = 1.818357216161805012e-01;
+static const double Lg6 = 1.531383769920937332e-01;
+static const double Lg7 = 1.479819860511658591e-01;
+static const double Sqrt2 = 1.41421356237309504880;
+
+static void logBlockScalar(double *x, size_t n) {
+    for(size_t i = 0; i < n; i++) {
+        uint64_t bits;
+        std::memcpy(&bits, &x[i], sizeof bits);
+
+        double k = (double) ((int) (bits >> 52) - 1023);
+        bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+
+        double m;
+        std::memcpy(&m, &bits, sizeof m);
+        if(m > Sqrt2) {
+            m = m * 0.5;
+            k = k + 1.0;
+        }
+
+        double f = m - 1.0;
+        double s = f / (2.0 + f);
+        double z = s * s;
+        double w = z * z;
+        double r = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7))) + w * (Lg2 + w * (Lg4 + w * Lg6));
+        double hfsq = 0.5 * f * f;
+
+        x[i] = k * Ln2Hi - ((hfsq - (s * (hfsq + r) + k * Ln2Lo)) - f);
+    }
+}
+
+#ifdef RANDGEN_X86
+
+__attribute__((target("avx2")))
+static size_t logBlockAvx2(double *x, size_t n) {
+    const __m256i mantissa = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m256i one = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256d bias = _mm256_set1_pd(4503599627370496.0 + 1023.0);
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256i bits = _mm256_castpd_si256(_mm256_loadu_pd(x + i));
+        __m256d k = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), magic)), bias);
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissa), one));
+
+        __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(Sqrt2), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+        k = _mm256_add_pd(k, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+        __m256d f = _mm256_sub_pd(m, _mm256_set1_pd(1.0));
+        __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+        __m256d z = _mm256_mul_pd(s, s);
+        __m256d w = _mm256_mul_pd(z, z);
+        __m256d t1 = _mm256_mul_pd(z, _mm256_add_pd(_mm256_set1_pd(Lg1), _mm256_mul_pd(w, _mm256_add_pd(_mm256_set1_pd(Lg3),
+                         _mm256_mul_pd(w, _mm256_add_pd(_mm256_set1_pd(Lg5), _mm256_mul_pd(w, _mm256_set1_pd(Lg7))))))));
+        __m256d t2 = _mm256_mul_pd(w, _mm256_add_pd(_mm256_set1_pd(Lg2), _mm256_mul_pd(w, _mm256_add_pd(_mm256_set1_pd(Lg4),
+                         _mm256_mul_pd(w, _mm256_set1_pd(Lg6))))));
+        __m256d r = _mm256_add_pd(t1, t2);
+        __m256d hfsq = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), f), f);
+
+        __m256d inner = _mm256_add_pd(_mm256_mul_pd(s, _mm256_add_pd(hfsq, r)), _mm256_mul_pd(k, _mm256_set1_pd(Ln2Lo)));
+        __m256d result = _mm256_sub_pd(_mm256_mul_pd(k, _mm256_set1_pd(Ln2Hi)), _mm256_sub_pd(_mm256_sub_pd(hfsq, inner), f));
+        _mm256_storeu_pd(x + i, result);
+    }
+
+    return i;
+}
+
+#endif
+
+void logBlock(double *x, size_t n) {
+    size_t done = 0;
+
+#ifdef RANDGEN_X86
+    if(__builtin_cpu_supports("avx2")) {
+        done = logBlockAvx2(x, n);
+    }
+#endif
+
+    logBlockScalar(x + done, n - done);
+}
+
+// Triangular inverse transform with c = (m - a) / (b - a): a + (b - a) sqrt(c u)
+// for u <= c and a + (b - a) (1 - sqrt((1 - c)(1 - u))) above it.  Both branches
+// are computed and blended in the AVX2 version, in the same order as the scalar
+// one, so the two give identical results.
+
+static void triangularBlockScalar(double *x, size_t n, double a, double c, double width) {
+    for(size_t i = 0; i < n; i++) {
+        double u = x[i];
+        x[i] = a + width * (c < u ? 1.0 - sqrt((1.0 - c) * (1.0 - u)) : sqrt(c * u));
+    }
+}
+
+#ifdef RANDGEN_X86
+
+__attribute__((target("avx2")))
+static size_t triangularBlockAvx2(double *x, size_t n, double a, double c, double width) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d vc = _mm256_set1_pd(c);
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d vwidth = _mm256_set1_pd(width);
+    size_t i;
+
+    for(i = 0; i + 4 <= n; i += 4) {
+        __m256d u = _mm256_loadu_pd(x + i);
+        __m256d low = _mm256_sqrt_pd(_mm256_mul_pd(vc, u));
+        __m256d high = _mm256_sub_pd(one, _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(one, vc), _mm256_sub_pd(one, u))));
+        __m256d t = _mm256_blendv_pd(low, high, _mm256_cmp_pd(vc, u, _CMP_LT_OQ));
+        _mm256_storeu_pd(x + i, _mm256_add_pd(va, _mm256_mul_pd(vwidth, t)));
+    }
+
+    return i;
+}
+
+#endif
+
+void triangularBlock(double *x, size_t n, double a, double m, double b) {
+    double c = a == b ? 0.0 : (m - a) / (b - a);
+    size_t done = 0;
+
+#ifdef RANDGEN_X86
+    if(__builtin_cpu_supports("avx2")) {
+        done = triangularBlockAvx2(x, n, a, c, b - a);
+    }
+#endif
+
+    triangularBlockScalar(x + done, n - done, a, c, b - a);
+}
\ No newline at end of file
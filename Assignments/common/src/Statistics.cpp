@@ -0,0 +1,232 @@
+#include "../include/Statistics.h"
+#include <algorithm>
+#include <cmath>
+
+void RunningStat::addBlock(const double *x, size_t n) {
+    RunningStat block;
+    double sum = 0.0, m2 = 0.0;
+
+    if(n == 0) {
+        return;
+    }
+    for(size_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+    block.n = (long) n;
+    block.average = sum / n;
+    for(size_t i = 0; i < n; i++) {
+        m2 += (x[i] - block.average) * (x[i] - block.average);
+    }
+    block.m2 = m2;
+
+    this->merge(block);
+}
+
+void RunningStat::merge(const RunningStat &other) {
+    if(other.n == 0) {
+        return;
+    }
+
+    long n = this->n + other.n;
+    double delta = other.average - this->average;
+
+    this->m2 += other.m2 + delta * delta * ((double) this->n * other.n / n);
+    this->average += delta * other.n / n;
+    this->n = n;
+}
+
+BatchMeans::BatchMeans(int batches) : batches(batches) {
+    this->clear();
+}
+
+void BatchMeans::clear() {
+    this->means.clear();
+    this->means.reserve(2 * this->batches);
+    this->partial = 0.0;
+    this->inBatch = 0;
+    this->size = 1;
+    this->n = 0;
+}
+
+void BatchMeans::closeBatch() {
+    this->means.push_back(this->partial / this->size);
+    this->partial = 0.0;
+    this->inBatch = 0;
+
+    // Too many batches: merge neighbours and double the batch size
+    if((int) this->means.size() == 2 * this->batches) {
+        for(int i = 0; i < this->batches; i++) {
+            this->means[i] = 0.5 * (this->means[2 * i] + this->means[2 * i + 1]);
+        }
+        this->means.resize(this->batches);
+        this->size *= 2;
+    }
+}
+
+RunningStat BatchMeans::batchStat() const {
+    RunningStat stat;
+
+    for(double mean : this->means) {
+        stat.add(mean);
+    }
+
+    return stat;
+}
+
+double BatchMeans::lag1Correlation() const {
+    RunningStat stat = this->batchStat();
+    double sum = 0.0;
+
+    if(this->means.size() < 3 || stat.variance() == 0.0) {
+        return 0.0;
+    }
+    for(size_t i = 0; i + 1 < this->means.size(); i++) {
+        sum += (this->means[i] - stat.mean()) * (this->means[i + 1] - stat.mean());
+    }
+
+    return sum / (this->means.size() - 1) / stat.variance();
+}
+
+void RatioStat::merge(const RatioStat &other) {
+    if(other.n == 0) {
+        return;
+    }
+
+    long n = this->n + other.n;
+    double dy = other.meanY - this->meanY;
+    double dx = other.meanX - this->meanX;
+    double weight = (double) this->n * other.n / n;
+
+    this->cYY += other.cYY + dy * dy * weight;
+    this->cXX += other.cXX + dx * dx * weight;
+    this->cXY += other.cXY + dx * dy * weight;
+    this->meanY += dy * other.n / n;
+    this->meanX += dx * other.n / n;
+    this->n = n;
+}
+
+double RatioStat::residualVariance() const {
+    double r = this->ratio();
+
+    if(this->n < 2) {
+        return 0.0;
+    }
+    return (this->cYY - 2.0 * r * this->cXY + r * r * this->cXX) / (this->n - 1);
+}
+
+// Continued fraction for the regularized incomplete beta function, by the
+// modified Lentz method (Numerical Recipes, betacf)
+static double betaContinuedFraction(double a, double b, double x) {
+    const double tiny = 1.0e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+
+    d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+    double h = d;
+
+    for(int m = 1; m <= 300; m++) {
+        double m2 = 2.0 * m;
+        double aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+
+        d = 1.0 + aa * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + aa / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        h *= d * c;
+
+        aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + aa * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + aa / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        double del = d * c;
+        h *= del;
+
+        if(std::fabs(del - 1.0) < 1.0e-15) {
+            break;
+        }
+    }
+
+    return h;
+}
+
+// Regularized incomplete beta function I_x(a, b)
+static double incompleteBeta(double a, double b, double x) {
+    if(x <= 0.0) {
+        return 0.0;
+    }
+    if(x >= 1.0) {
+        return 1.0;
+    }
+
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+
+    if(x < (a + 1.0) / (a + b + 2.0)) {
+        return front * betaContinuedFraction(a, b, x) / a;
+    }
+    return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+}
+
+// P(T <= t) for Student's t with df degrees of freedom
+static double studentTCdf(double t, long df) {
+    double tail = 0.5 * incompleteBeta(0.5 * df, 0.5, df / (df + t * t));
+    return t > 0.0 ? 1.0 - tail : tail;
+}
+
+double studentTQuantile(double p, long df) {
+    if(p == 0.5) {
+        return 0.0;
+    }
+    if(p < 0.5) {
+        return -studentTQuantile(1.0 - p, df);
+    }
+
+    // Bracket the quantile, then bisect; the cdf is monotone so this always converges
+    double lo = 0.0, hi = 1.0;
+    while(studentTCdf(hi, df) < p && hi < 1.0e12) {
+        lo = hi;
+        hi *= 2.0;
+    }
+    for(int i = 0; i < 200 && hi - lo > 1.0e-12 * hi; i++) {
+        double mid = 0.5 * (lo + hi);
+        if(studentTCdf(mid, df) < p) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return 0.5 * (lo + hi);
+}
+
+ConfidenceInterval confidenceInterval(const RunningStat &stat, double confidence) {
+    ConfidenceInterval interval;
+
+    interval.mean = stat.mean();
+    interval.n = stat.count();
+    interval.halfLength = 0.0;
+    if(stat.count() > 1) {
+        double t = studentTQuantile(1.0 - (1.0 - confidence) / 2.0, stat.count() - 1);
+        interval.halfLength = t * std::sqrt(stat.variance() / stat.count());
+    }
+
+    return interval;
+}
+
+ConfidenceInterval confidenceInterval(const BatchMeans &batches, double confidence) {
+    return confidenceInterval(batches.batchStat(), confidence);
+}
+
+ConfidenceInterval confidenceInterval(const RatioStat &stat, double confidence) {
+    ConfidenceInterval interval;
+
+    interval.mean = stat.ratio();
+    interval.n = stat.count();
+    interval.halfLength = 0.0;
+    if(stat.count() > 1 && stat.meanDenominator() != 0.0) {
+        double t = studentTQuantile(1.0 - (1.0 - confidence) / 2.0, stat.count() - 1);
+        interval.halfLength = t * std::sqrt(std::max(stat.residualVariance(), 0.0) / stat.count()) / std::fabs(stat.meanDenominator());
+    }
+
+    return interval;
+}
\ No newline at end of file
@@ -0,0 +1,381 @@
+/* Prime modulus multiplicative linear congruential generator
+   Z[i] = (630360016 * Z[i-1]) (mod(pow(2,31) - 1)), based on Marse and Roberts'
+   portable FORTRAN random-number generator UNIRAN.  Multiple (100) streams are
+   supported, with seeds spaced 100,000 apart.  Throughout, input argument
+   "stream" must be an int giving the desired stream number.  The header file
+   lcgrand.h must be included in the calling program (#include "lcgrand.h")
+   before using these functions.
+
+   Usage: (Three functions)
+
+   1. To obtain the next U(0,1) random number from stream "stream," execute
+          u = lcgrand(stream);
+      where lcgrand is a float function.  The float variable u will contain the
+      next random number.
+
+   2. To set the seed for stream "stream" to a desired value zset, execute
+          lcgrandst(zset, stream);
+      where lcgrandst is a void function and zset must be a long set to the
+      desired seed, a number between 1 and 2147483646 (inclusive).  Default
+      seeds for all 100 streams are given in the code.
+
+   3. To get the current (most recently used) integer in the sequence being
+      generated for stream "stream" into the long variable zget, execute
+          zget = lcgrandgt(stream);
+      where lcgrandgt is a long function.
+
+   The three functions above share one table of streams and must not be called
+   concurrently.  Code that owns its generator should instead keep an
+   LcgStream, obtained with
+          LcgStream s = lcgrandstream(stream);
+   and draw from it with u = lcgrand(s), which touches no shared state.
+
+   Since one call multiplies by MULT1 and then MULT2, n calls multiply the
+   state by MULT^n (mod MODLUS).  lcgrandjump and lcgrandsubstream use this to
+   skip ahead by square-and-multiply, which gives any number of disjoint
+   substreams instead of the 100 fixed seeds below. */
+
+#include "../include/lcgrand.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define LCGRAND_X86 1
+#endif
+
+/* Set the default seeds for all 100 streams. */
+
+static long zrng[] =
+    {1,
+     1973272912, 281629770, 20006270, 1280689831, 2096730329, 1933576050,
+     913566091, 246780520, 1363774876, 604901985, 1511192140, 1259851944,
+     824064364, 150493284, 242708531, 75253171, 1964472944, 1202299975,
+     233217322, 1911216000, 726370533, 403498145, 993232223, 1103205531,
+     762430696, 1922803170, 1385516923, 76271663, 413682397, 726466604,
+     336157058, 1432650381, 1120463904, 595778810, 877722890, 1046574445,
+     68911991, 2088367019, 748545416, 622401386, 2122378830, 640690903,
+     1774806513, 2132545692, 2079249579, 78130110, 852776735, 1187867272,
+     1351423507, 1645973084, 1997049139, 922510944, 2045512870, 898585771,
+     243649545, 1004818771, 773686062, 403188473, 372279877, 1901633463,
+     498067494, 2087759558, 493157915, 597104727, 1530940798, 1814496276,
+     536444882, 1663153658, 855503735, 67784357, 1432404475, 619691088,
+     119025595, 880802310, 176192644, 1116780070, 277854671, 1366580350,
+     1142483975, 2026948561, 1053920743, 786262391, 1792203830, 1494667770,
+     1923011392, 1433700034, 1244184613, 1147297105, 539712780, 1545929719,
+     190641742, 1645390429, 264907697, 620389253, 1502074852, 927711160,
+     364849192, 2049576050, 638580085, 547070247};
+
+/* Make an owned stream starting from the seed of stream "stream". */
+
+LcgStream lcgrandstream(int stream)
+{
+    LcgStream s;
+
+    s.seed = zrng[stream];
+    s.zi = zrng[stream];
+    s.id = stream;
+    return s;
+}
+
+/* Compute x * y (mod MODLUS) without overflow. */
+
+static long mulmod(long x, long y)
+{
+    return (long)((long long)x * y % MODLUS);
+}
+
+/* Reduce n modulo PERIOD into [0, PERIOD), so that a negative count steps
+   back through the cycle. */
+
+static long long reduceperiod(long long n)
+{
+    n %= PERIOD;
+    if (n < 0)
+        n += PERIOD;
+    return n;
+}
+
+/* Compute MULT^n (mod MODLUS) by square-and-multiply. */
+
+static long multpow(long long n)
+{
+    long result = 1, base = MULT;
+
+    n = reduceperiod(n);
+    while (n > 0)
+    {
+        if (n & 1)
+            result = mulmod(result, base);
+        base = mulmod(base, base);
+        n >>= 1;
+    }
+    return result;
+}
+
+/* Advance stream by n draws; a negative n moves it back. */
+
+void lcgrandjump(LcgStream &stream, long long n)
+{
+    stream.zi = mulmod(stream.zi, multpow(n));
+}
+
+/* Make the stream that starts index * spacing draws after base. */
+
+LcgStream lcgrandsubstream(const LcgStream &base, long long index, long long spacing)
+{
+    LcgStream s = base;
+    long step = multpow(spacing), jump = 1;
+
+    /* (MULT^spacing)^index, so that index * spacing cannot overflow */
+    index = reduceperiod(index);
+    while (index > 0)
+    {
+        if (index & 1)
+            jump = mulmod(jump, step);
+        step = mulmod(step, step);
+        index >>= 1;
+    }
+    s.zi = mulmod(base.zi, jump);
+    s.seed = s.zi;
+    return s;
+}
+
+/* Make count disjoint substreams of base, spacing draws apart. */
+
+std::vector<LcgStream> lcgrandsubstreams(const LcgStream &base, long long count, long long spacing)
+{
+    std::vector<LcgStream> streams;
+    long step = multpow(spacing);
+    LcgStream s = base;
+
+    streams.reserve(count);
+    for (long long i = 0; i < count; ++i)
+    {
+        s.seed = s.zi;
+        streams.push_back(s);
+        s.zi = mulmod(s.zi, step);
+    }
+    return streams;
+}
+
+/* Largest number of disjoint substreams with the given spacing. */
+
+long long lcgrandmaxsubstreams(long long spacing)
+{
+    return spacing > 0 ? PERIOD / spacing : 0;
+}
+
+/* Block generation.  Lane k of an L-lane block holds the state k + 1 draws
+   ahead, and every lane is advanced by MULT^L, so the lanes together emit the
+   sequence in order.  Products of two 31-bit numbers are reduced with
+   x mod (2^31 - 1) = (x & MODLUS) + (x >> 31), followed by one subtraction.
+   The integer states are below 2^31, so (zi >> 7 | 1) is converted exactly by
+   OR-ing it into the mantissa of 2^52, and multiplying by 2^-24 is exact. */
+
+#define LCGRAND_LANES 8
+
+static void fillscalar(int64_t *lane, int64_t step, double *out, size_t blocks)
+{
+    for (size_t b = 0; b < blocks; ++b, out += LCGRAND_LANES)
+        for (int k = 0; k < LCGRAND_LANES; ++k)
+        {
+            int64_t p = lane[k] * step;
+            int64_t zi = (p & MODLUS) + (p >> 31);
+
+            out[k] = (double)(lane[k] >> 7 | 1) / 16777216.0;
+            lane[k] = zi >= MODLUS ? zi - MODLUS : zi;
+        }
+}
+
+#ifdef LCGRAND_X86
+
+__attribute__((target("avx2")))
+static inline __m256i mulmodavx2(__m256i z, __m256i step)
+{
+    const __m256i mod = _mm256_set1_epi64x(MODLUS);
+    __m256i p = _mm256_mul_epu32(z, step);
+    __m256i r = _mm256_add_epi64(_mm256_and_si256(p, mod), _mm256_srli_epi64(p, 31));
+    __m256i over = _mm256_cmpgt_epi64(r, _mm256_set1_epi64x(MODLUS - 1));
+
+    return _mm256_sub_epi64(r, _mm256_and_si256(over, mod));
+}
+
+__attribute__((target("avx2")))
+static inline __m256d touniformavx2(__m256i z)
+{
+    const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    __m256i bits = _mm256_or_si256(_mm256_srli_epi64(z, 7), _mm256_set1_epi64x(1));
+    __m256d x = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(bits, magic)),
+                              _mm256_set1_pd(4503599627370496.0));
+
+    return _mm256_mul_pd(x, _mm256_set1_pd(1.0 / 16777216.0));
+}
+
+__attribute__((target("avx2")))
+static void fillavx2(int64_t *lane, int64_t step, double *out, size_t blocks)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)lane);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(lane + 4));
+    __m256i m = _mm256_set1_epi64x(step);
+
+    for (size_t i = 0; i < blocks; ++i, out += LCGRAND_LANES)
+    {
+        _mm256_storeu_pd(out, touniformavx2(a));
+        _mm256_storeu_pd(out + 4, touniformavx2(b));
+        a = mulmodavx2(a, m);
+        b = mulmodavx2(b, m);
+    }
+    _mm256_storeu_si256((__m256i *)lane, a);
+    _mm256_storeu_si256((__m256i *)(lane + 4), b);
+}
+
+/* SSE2 is part of x86-64, so this is the baseline vector path. */
+
+static inline __m128i mulmodsse2(__m128i z, __m128i step)
+{
+    const __m128i mod = _mm_set1_epi64x(MODLUS);
+    __m128i p = _mm_mul_epu32(z, step);
+    __m128i r = _mm_add_epi64(_mm_and_si128(p, mod), _mm_srli_epi64(p, 31));
+    /* r < 2^32, so comparing the low 32 bits as signed after a bias is enough */
+    __m128i over = _mm_cmpgt_epi32(_mm_xor_si128(r, _mm_set1_epi64x(0x80000000LL)),
+                                   _mm_set1_epi64x(MODLUS - 1 - 0x80000000LL));
+
+    over = _mm_shuffle_epi32(over, _MM_SHUFFLE(2, 2, 0, 0));
+    return _mm_sub_epi64(r, _mm_and_si128(over, mod));
+}
+
+static inline __m128d touniformsse2(__m128i z)
+{
+    const __m128i magic = _mm_set1_epi64x(0x4330000000000000LL);
+    __m128i bits = _mm_or_si128(_mm_srli_epi64(z, 7), _mm_set1_epi64x(1));
+    __m128d x = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(bits, magic)),
+                           _mm_set1_pd(4503599627370496.0));
+
+    return _mm_mul_pd(x, _mm_set1_pd(1.0 / 16777216.0));
+}
+
+static void fillsse2(int64_t *lane, int64_t step, double *out, size_t blocks)
+{
+    __m128i z[LCGRAND_LANES / 2];
+    __m128i m = _mm_set1_epi64x(step);
+
+    for (int k = 0; k < LCGRAND_LANES / 2; ++k)
+        z[k] = _mm_loadu_si128((const __m128i *)(lane + 2 * k));
+    for (size_t i = 0; i < blocks; ++i, out += LCGRAND_LANES)
+        for (int k = 0; k < LCGRAND_LANES / 2; ++k)
+        {
+            _mm_storeu_pd(out + 2 * k, touniformsse2(z[k]));
+            z[k] = mulmodsse2(z[k], m);
+        }
+    for (int k = 0; k < LCGRAND_LANES / 2; ++k)
+        _mm_storeu_si128((__m128i *)(lane + 2 * k), z[k]);
+}
+
+#endif
+
+/* Fill out with the next n random numbers from stream, using the given block
+   path for the bulk of them. */
+
+static void fillwith(LcgFillPath path, LcgStream &stream, double *out, size_t n)
+{
+    size_t blocks = n / LCGRAND_LANES, done = blocks * LCGRAND_LANES;
+
+    if (blocks > 1)
+    {
+        int64_t lane[LCGRAND_LANES], step = multpow(LCGRAND_LANES);
+        LcgStream s = stream;
+
+        for (int k = 0; k < LCGRAND_LANES; ++k)
+        {
+            lcgrand(s);
+            lane[k] = s.zi;
+        }
+#ifdef LCGRAND_X86
+        if (path == LCGFILL_AVX2)
+            fillavx2(lane, step, out, blocks);
+        else if (path == LCGFILL_SSE2)
+            fillsse2(lane, step, out, blocks);
+        else
+#endif
+            fillscalar(lane, step, out, blocks);
+        lcgrandjump(stream, (long long)done);
+    }
+    else
+        done = 0;
+
+    for (size_t i = done; i < n; ++i)
+        out[i] = lcgrand(stream);
+}
+
+/* Whether this machine can run the given block path. */
+
+bool lcgrandfillsupported(LcgFillPath path)
+{
+#ifdef LCGRAND_X86
+    if (path == LCGFILL_AVX2)
+        return __builtin_cpu_supports("avx2");
+    return true;
+#else
+    return path == LCGFILL_SCALAR;
+#endif
+}
+
+/* Fill out with the next n random numbers from stream. */
+
+void lcgrandfill(LcgStream &stream, double *out, size_t n)
+{
+    static const LcgFillPath best = lcgrandfillsupported(LCGFILL_AVX2) ? LCGFILL_AVX2
+                                  : lcgrandfillsupported(LCGFILL_SSE2) ? LCGFILL_SSE2
+                                                                       : LCGFILL_SCALAR;
+
+    fillwith(best, stream, out, n);
+}
+
+/* Check that the given block path reproduces repeated calls to lcgrand, value
+   by value and in the final state, for block lengths around the lane count. */
+
+bool lcgrandfillcheck(LcgFillPath path)
+{
+    const size_t lengths[] = {1, 7, 8, 16, 17, 1000};
+    std::vector<double> filled(1000);
+
+    for (int stream = 1; stream <= 3; ++stream)
+        for (size_t n : lengths)
+        {
+            LcgStream a = lcgrandstream(stream), b = a;
+
+            fillwith(path, a, filled.data(), n);
+            for (size_t i = 0; i < n; ++i)
+                if (filled[i] != lcgrand(b))
+                    return false;
+            if (a.zi != b.zi)
+                return false;
+        }
+    return true;
+}
+
+/* Generate the next random number. */
+
+double lcgrand(int stream)
+{
+    LcgStream s = lcgrandstream(stream);
+    double u = lcgrand(s);
+
+    zrng[stream] = s.zi;
+    return u;
+}
+
+/* Set the current zrng for stream "stream" to zset. */
+
+void lcgrandst(long zset, int stream)
+{
+    zrng[stream] = zset;
+}
+
+/* Return the current zrng for stream "stream". */
+
+long lcgrandgt(int stream)
+{
+    return zrng[stream];
+}
\ No newline at end of file